@@ -0,0 +1,42 @@
+#include "arena.h"
+#include <cstdlib>  // For std::malloc, std::free, std::exit
+#include <cstring>  // For std::memcpy
+#include <cstdio>   // For fprintf
+
+Arena::Arena(std::size_t blockSize) : blockSize(blockSize) {}
+
+Arena::~Arena() {
+    for (const Block& block : blocks) std::free(block.data);
+}
+
+void* Arena::allocateSlow(std::size_t size, std::size_t align) {
+    // Oversized requests get a dedicated block so the regular block size stays small.
+    std::size_t needed = size + align;
+    std::size_t bytes = needed > blockSize ? needed : blockSize;
+    char* block = static_cast<char*>(std::malloc(bytes));
+    if (!block) {
+        fprintf(stderr, "CRITICAL ERROR: Arena could not allocate a %zu byte block. Exiting.\n", bytes);
+        std::exit(1);
+    }
+    blocks.push_back({block, bytes});
+    totalBytes += bytes;
+    cursor = block;
+    limit = block + bytes;
+    return allocate(size, align);
+}
+
+const char* Arena::copyString(const char* s, std::size_t n) {
+    char* copy = static_cast<char*>(allocate(n + 1, 1));
+    std::memcpy(copy, s, n);
+    copy[n] = '\0';
+    return copy;
+}
+
+void Arena::reset() {
+    if (blocks.empty()) return;
+    for (std::size_t i = 1; i < blocks.size(); ++i) std::free(blocks[i].data);
+    blocks.resize(1);
+    cursor = blocks[0].data;
+    limit = blocks[0].data + blocks[0].size;
+    totalBytes = blocks[0].size;
+}
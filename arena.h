@@ -0,0 +1,56 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>  // For std::size_t, std::max_align_t
+#include <cstdint>  // For std::uintptr_t
+#include <new>      // For placement new
+#include <utility>  // For std::forward
+#include <vector>   // For std::vector
+
+// Bump allocator that owns every object carved out of it.
+// Objects are never freed individually; reset() drops all of them at once,
+// so only trivially destructible types should be allocated here.
+class Arena {
+public:
+    explicit Arena(std::size_t blockSize = 64 * 1024);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t align = alignof(std::max_align_t)) {
+        std::uintptr_t p = (reinterpret_cast<std::uintptr_t>(cursor) + align - 1) & ~(std::uintptr_t)(align - 1);
+        if (p + size > reinterpret_cast<std::uintptr_t>(limit)) return allocateSlow(size, align);
+        cursor = reinterpret_cast<char*>(p + size);
+        return reinterpret_cast<void*>(p);
+    }
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Copies n bytes of s into the arena and NUL-terminates the copy.
+    const char* copyString(const char* s, std::size_t n);
+
+    // Releases every block except the first, which is kept for reuse.
+    void reset();
+
+    std::size_t bytesAllocated() const { return totalBytes; }
+
+private:
+    void* allocateSlow(std::size_t size, std::size_t align);
+
+    struct Block {
+        char* data;
+        std::size_t size;
+    };
+
+    std::size_t blockSize;
+    std::vector<Block> blocks;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    std::size_t totalBytes = 0;
+};
+
+#endif // ARENA_H
@@ -0,0 +1,101 @@
+#include "asm_emitter.h"
+#include "diagnostics.h"
+#include <charconv>  // For std::to_chars
+#include <cerrno>
+#include <cstdarg>
+#include <fcntl.h>   // For open
+#include <unistd.h>  // For write, close
+
+void AsmEmitter::warn(const char* format, ...) {
+    char text[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (diagnostics) {
+        diagnostics->report("%s", text);
+    } else {
+        fputs(text, stderr);
+        fflush(stderr);
+    }
+}
+
+AsmEmitter::AsmEmitter(const SymbolTable& symbols) : symbols(symbols), kind(Sink::Memory) {}
+
+AsmEmitter::AsmEmitter(const SymbolTable& symbols, const std::string& path)
+    : symbols(symbols), kind(Sink::File) {
+    fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    failed = fd < 0;
+    buffer.reserve(kFlushThreshold + 4096);
+}
+
+AsmEmitter::AsmEmitter(const SymbolTable& symbols, FILE* stream)
+    : symbols(symbols), kind(Sink::Stream), stream(stream) {
+    failed = stream == nullptr;
+    buffer.reserve(kFlushThreshold + 4096);
+}
+
+AsmEmitter::~AsmEmitter() {
+    finish();
+    if (fd >= 0) close(fd);
+}
+
+AsmEmitter& AsmEmitter::append(int value) {
+    char digits[16];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr - digits);
+    return *this;
+}
+
+AsmEmitter& AsmEmitter::append(const Operand& operand) {
+    switch (operand.kind) {
+        case OperandKind::None:
+            break;
+        case OperandKind::Temp:
+            buffer.push_back('t');
+            append(operand.value);
+            break;
+        case OperandKind::Var:
+            append(symbols.name(static_cast<Symbol>(operand.value)));
+            break;
+        case OperandKind::Imm:
+            append(operand.value);
+            break;
+        case OperandKind::Label:
+            buffer.push_back('L');
+            append(operand.value);
+            break;
+    }
+    return *this;
+}
+
+void AsmEmitter::flushBuffer() {
+    if (buffer.empty() || kind == Sink::Memory) return;
+    if (echo) fwrite(buffer.data(), 1, buffer.size(), echo);
+    if (!failed) {
+        if (kind == Sink::File) {
+            const char* data = buffer.data();
+            size_t remaining = buffer.size();
+            while (remaining > 0) {
+                ssize_t written = write(fd, data, remaining);
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    failed = true;
+                    break;
+                }
+                data += written;
+                remaining -= written;
+            }
+        } else if (fwrite(buffer.data(), 1, buffer.size(), stream) != buffer.size()) {
+            failed = true;
+        }
+    }
+    buffer.clear();
+}
+
+bool AsmEmitter::finish() {
+    flushBuffer();
+    if (kind == Sink::Stream && stream && !failed) failed = fflush(stream) != 0;
+    if (echo) fflush(echo);
+    return !failed;
+}
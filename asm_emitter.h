@@ -0,0 +1,87 @@
+#ifndef ASM_EMITTER_H
+#define ASM_EMITTER_H
+
+#include "three_address_code.h" // For Operand
+#include "symbol_table.h"       // For SymbolTable
+#include <cstdio>      // For FILE
+#include <string>
+#include <string_view>
+
+class Diagnostics;
+
+// Accumulates generated assembly in one growable buffer and hands it to a sink in bulk.
+// Lines are assembled piecewise with line(...), which appends each part in place
+// instead of building temporary strings. Variable operands are spelled through the
+// compilation's symbol table, which must outlive the emitter.
+class AsmEmitter {
+public:
+    enum class Sink { File, Stream, Memory };
+
+    // Memory sink: nothing is written anywhere; read the text back with contents().
+    explicit AsmEmitter(const SymbolTable& symbols);
+    // File sink: truncates `path` now; text is written in large chunks and on finish().
+    AsmEmitter(const SymbolTable& symbols, const std::string& path);
+    // Stream sink (e.g. stdout).
+    AsmEmitter(const SymbolTable& symbols, FILE* stream);
+    ~AsmEmitter();
+
+    AsmEmitter(const AsmEmitter&) = delete;
+    AsmEmitter& operator=(const AsmEmitter&) = delete;
+
+    // Also copy every chunk handed to the sink to `stream` (e.g. to show it on the terminal).
+    void setEcho(FILE* stream) { echo = stream; }
+
+    // Report generator warnings there (so a library caller gets them with the compile
+    // errors) instead of on stderr.
+    void setDiagnostics(Diagnostics* sink) { diagnostics = sink; }
+    // A printf-style warning about the quads being translated, one line with its '\n'.
+    void warn(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    bool ok() const { return !failed; }
+    const SymbolTable& symbolTable() const { return symbols; }
+    Sink sink() const { return kind; }
+
+    AsmEmitter& append(std::string_view text) { buffer.append(text.data(), text.size()); return *this; }
+    AsmEmitter& append(const char* text) { return append(std::string_view(text)); }
+    AsmEmitter& append(const std::string& text) { return append(std::string_view(text)); }
+    AsmEmitter& append(char c) { buffer.push_back(c); return *this; }
+    AsmEmitter& append(int value);
+    AsmEmitter& append(const Operand& operand);
+
+    // Appends all parts followed by a newline.
+    template <typename... Parts>
+    void line(const Parts&... parts) {
+        (append(parts), ...);
+        buffer.push_back('\n');
+        if (kind != Sink::Memory && buffer.size() >= kFlushThreshold) flushBuffer();
+    }
+
+    // Appends a piece of finished text (e.g. code copied from another emitter's file),
+    // handing the buffer to the sink once it is large, as line() does.
+    void appendChunk(std::string_view text) {
+        append(text);
+        if (kind != Sink::Memory && buffer.size() >= kFlushThreshold) flushBuffer();
+    }
+
+    // Text emitted so far that has not been handed to the sink (all of it for Memory).
+    std::string_view contents() const { return buffer; }
+
+    // Writes whatever is still buffered to the sink. Returns false if any write failed.
+    bool finish();
+
+private:
+    static constexpr std::size_t kFlushThreshold = 1 << 20;
+
+    void flushBuffer();
+
+    const SymbolTable& symbols;
+    Sink kind;
+    int fd = -1;
+    FILE* stream = nullptr;
+    FILE* echo = nullptr;
+    Diagnostics* diagnostics = nullptr;
+    bool failed = false;
+    std::string buffer;
+};
+
+#endif // ASM_EMITTER_H
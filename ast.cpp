@@ -1,89 +1,184 @@
+
 #include "ast.h"
+#include "packed_ast.h"
 #include <string>
-#include <iostream> // For std::cout in printAST
-#include <cstdio>   // For fprintf, fflush (used for error messages)
-#include <vector> 
+#include <ostream> // For std::ostream in printAST
+#include <vector>
+#include <algorithm> // For std::reverse
+
+const char* nodeKindName(NodeKind kind) {
+    switch (kind) {
+        case NodeKind::StmtList:      return "stmt_list";
+        case NodeKind::Assign:        return "assign";
+        case NodeKind::Id:            return "id";
+        case NodeKind::Num:           return "num";
+        case NodeKind::Op:            return "op";
+        case NodeKind::If:            return "if";
+        case NodeKind::While:         return "while";
+        case NodeKind::For:           return "for";
+        case NodeKind::Switch:        return "switch";
+        case NodeKind::CaseListEntry: return "case_list_entry";
+        case NodeKind::Case:          return "case";
+        case NodeKind::DefaultCase:   return "default_case";
+        case NodeKind::Break:         return "break";
+    }
+    return "<UNKNOWN_NODE_KIND>";
+}
+
+const char* opKindText(OpKind op) {
+    switch (op) {
+        case OpKind::Add:     return "+";
+        case OpKind::Sub:     return "-";
+        case OpKind::Mul:     return "*";
+        case OpKind::Div:     return "/";
+        case OpKind::Mod:     return "%";
+        case OpKind::Lt:      return "<";
+        case OpKind::Gt:      return ">";
+        case OpKind::Le:      return "<=";
+        case OpKind::Ge:      return ">=";
+        case OpKind::Eq:      return "==";
+        case OpKind::Ne:      return "!=";
+        case OpKind::PreInc:  return "++_pre";
+        case OpKind::PostInc: return "++_post";
+        case OpKind::PreDec:  return "--_pre";
+        case OpKind::PostDec: return "--_post";
+    }
+    return "<UNKNOWN_OP>";
+}
 
 // --- Node Creation Helpers ---
 
-ASTNode* createNumNode(int val) {
-    return new ASTNode("num", std::to_string(val));
+static ASTNode* newNode(Arena& arena, NodeKind kind, ASTNode* l = nullptr, ASTNode* r = nullptr,
+                        ASTNode* th = nullptr, ASTNode* f = nullptr) {
+    return arena.make<ASTNode>(kind, l, r, th, f);
 }
 
-ASTNode* createIdNode(char* name) {
-    if (name == nullptr) {
-        fprintf(stderr, "DEBUG CRITICAL ERROR: createIdNode received a null name. This can lead to a crash. Creating placeholder.\n");
-        fflush(stderr);
-        return new ASTNode("id", "<ERROR_NULL_ID_NAME>");
-    }
-    return new ASTNode("id", std::string(name));
+ASTNode* createNumNode(Arena& arena, int val) {
+    ASTNode* node = newNode(arena, NodeKind::Num);
+    node->num = val;
+    return node;
 }
 
-ASTNode* createOpNode(const std::string& op, ASTNode* l, ASTNode* r) {
-    return new ASTNode("op", op, l, r); // Handles +, -, *, /, <, >, ==, ++, -- etc.
+ASTNode* createIdNode(Arena& arena, Symbol name) {
+    ASTNode* node = newNode(arena, NodeKind::Id);
+    node->sym = name;
+    return node;
 }
 
-ASTNode* createAssignNode(char* name, ASTNode* expr) {
-    if (name == nullptr) {
-        fprintf(stderr, "DEBUG CRITICAL ERROR: createAssignNode received a null name for the identifier. This can lead to a crash. Creating placeholder.\n");
-        fflush(stderr);
-        return new ASTNode("assign", "<ERROR_NULL_ASSIGN_ID>", expr);
-    }
-    return new ASTNode("assign", std::string(name), expr);
+ASTNode* createOpNode(Arena& arena, OpKind op, ASTNode* l, ASTNode* r) {
+    ASTNode* node = newNode(arena, NodeKind::Op, l, r); // Handles +, -, *, /, <, >, ==, ++, -- etc.
+    node->op = op;
+    return node;
 }
 
-ASTNode* createIfNode(ASTNode* cond, ASTNode* thenStmt, ASTNode* elseStmt) {
-    return new ASTNode("if", "", cond, thenStmt, elseStmt);
+ASTNode* createAssignNode(Arena& arena, Symbol name, ASTNode* expr) {
+    ASTNode* node = newNode(arena, NodeKind::Assign, expr);
+    node->sym = name;
+    return node;
 }
 
-ASTNode* createWhileNode(ASTNode* cond, ASTNode* body) {
-    return new ASTNode("while", "", cond, body);
+ASTNode* createIfNode(Arena& arena, ASTNode* cond, ASTNode* thenStmt, ASTNode* elseStmt) {
+    return newNode(arena, NodeKind::If, cond, thenStmt, elseStmt);
 }
 
-ASTNode* createForNode(ASTNode* init, ASTNode* cond, ASTNode* inc, ASTNode* body) {
-    return new ASTNode("for", "", init, cond, inc, body);
+ASTNode* createWhileNode(Arena& arena, ASTNode* cond, ASTNode* body) {
+    return newNode(arena, NodeKind::While, cond, body);
 }
 
-ASTNode* createSwitchNode(ASTNode* expr, ASTNode* cases) {
-    return new ASTNode("switch", "", expr, cases);
+ASTNode* createForNode(Arena& arena, ASTNode* init, ASTNode* cond, ASTNode* inc, ASTNode* body) {
+    return newNode(arena, NodeKind::For, init, cond, inc, body);
 }
 
-ASTNode* createCaseNode(int val, ASTNode* body, ASTNode* next) {
-    return new ASTNode("case", std::to_string(val), body, next);
+ASTNode* createSwitchNode(Arena& arena, ASTNode* expr, ASTNode* cases) {
+    return newNode(arena, NodeKind::Switch, expr, cases);
 }
 
-ASTNode* createNode(const std::string& type, ASTNode* left, ASTNode* right) {
-    return new ASTNode(type, "", left, right);
+ASTNode* createCaseNode(Arena& arena, int val, ASTNode* body, ASTNode* next) {
+    ASTNode* node = newNode(arena, NodeKind::Case, body, next);
+    node->num = val;
+    return node;
 }
 
-// --- AST Printing ---
+ASTNode* createNode(Arena& arena, NodeKind kind, ASTNode* left, ASTNode* right) {
+    return newNode(arena, kind, left, right);
+}
 
-void printAST(ASTNode* node, const std::string& prefix, bool isLast) {
-    if (!node) return;
+// --- AST Printing ---
 
-    std::cout << prefix << (isLast ? "└── " : "├── ")
-              << node->type;
-    if (!node->value.empty()) {
-        std::cout << "(" << node->value << ")";
+void collectStatements(ASTNode* node, std::vector<ASTNode*>& out) {
+    size_t first = out.size();
+    while (node && node->kind == NodeKind::StmtList) {
+        if (node->right) out.push_back(node->right);
+        node = node->left;
     }
-    std::cout << std::endl;
+    if (node) out.push_back(node);
+    std::reverse(out.begin() + first, out.end());
+}
 
-    std::string newPrefix = prefix + (isLast ? "    " : "│   ");
-    std::vector<ASTNode*> children;
-    if (node->left) children.push_back(node->left);
-    if (node->right) children.push_back(node->right);
-    if (node->third) children.push_back(node->third);
-    if (node->fourth) children.push_back(node->fourth);
+// Iterative so that the depth of the tree (which for stmt_list spines equals the number
+// of statements) never turns into native stack depth. Written once for both layouts
+// (Node is TreeNodeRef or PackedNodeRef).
+template <typename Node>
+static void printTree(Node node, const SymbolTable& symbols, std::ostream& out, bool flattenLists) {
+    if (!node) return;
 
-    for (size_t i = 0; i < children.size(); ++i) {
-        printAST(children[i], newPrefix, i == children.size() - 1);
+    struct Pending {
+        Node node;
+        size_t prefixLength;
+        bool isLast;
+    };
+    std::string linePrefix;
+    std::vector<Pending> stack{{node, 0, true}};
+    std::vector<Node> children;
+
+    while (!stack.empty()) {
+        Pending item = stack.back();
+        stack.pop_back();
+        Node current = item.node;
+        linePrefix.resize(item.prefixLength);
+
+        out << linePrefix << (item.isLast ? "└── " : "├── ")
+                  << nodeKindName(current.kind());
+        switch (current.kind()) {
+            case NodeKind::Num:
+            case NodeKind::Case:
+                out << "(" << current.num() << ")";
+                break;
+            case NodeKind::Id:
+            case NodeKind::Assign:
+                out << "(" << symbols.name(current.sym()) << ")";
+                break;
+            case NodeKind::Op:
+                out << "(" << opKindText(current.op()) << ")";
+                break;
+            default:
+                break;
+        }
+        out << '\n';
+
+        linePrefix += (item.isLast ? "    " : "│   ");
+        children.clear();
+        if (flattenLists && current.kind() == NodeKind::StmtList) {
+            collectStatementsOf(current, children);
+        } else {
+            if (current.left()) children.push_back(current.left());
+            if (current.right()) children.push_back(current.right());
+            if (current.third()) children.push_back(current.third());
+            if (current.fourth()) children.push_back(current.fourth());
+        }
+
+        // Push in reverse so the first child is printed first.
+        for (size_t i = children.size(); i-- > 0;) {
+            stack.push_back({children[i], linePrefix.size(), i == children.size() - 1});
+        }
     }
+    out << std::flush;
 }
 
-// --- Compatibility wrapper ---
-void printAST(ASTNode* node, int indent) {
-    std::string prefix(indent * 2, ' ');
-    printAST(node, prefix, true);
+void printAST(ASTNode* node, const SymbolTable& symbols, std::ostream& out, bool flattenLists) {
+    printTree(TreeNodeRef(node), symbols, out, flattenLists);
 }
 
-
+void printAST(const PackedASTView& ast, const SymbolTable& symbols, std::ostream& out, bool flattenLists) {
+    printTree(packedRoot(ast), symbols, out, flattenLists);
+}
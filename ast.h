@@ -3,38 +3,83 @@
 
 #include <string>
 #include <iostream>
+#include <cstdint>
+#include <vector>
 
+#include "arena.h"
+#include "symbol_table.h"
+
+// Kinds of AST nodes. nodeKindName() gives the spelling used when printing the tree.
+enum class NodeKind : std::uint8_t {
+    StmtList,
+    Assign,
+    Id,
+    Num,
+    Op,
+    If,
+    While,
+    For,
+    Switch,
+    CaseListEntry,
+    Case,
+    DefaultCase,
+    Break
+};
+
+const char* nodeKindName(NodeKind kind);
+
+// Operators carried by Op nodes. opKindText() gives the spelling used when printing the tree.
+enum class OpKind : std::uint8_t {
+    Add, Sub, Mul, Div, Mod,
+    Lt, Gt, Le, Ge, Eq, Ne,
+    PreInc, PostInc, PreDec, PostDec
+};
+
+const char* opKindText(OpKind op);
+
+// AST nodes live in the compilation's arena and are never deleted one by one.
+// Num and Case carry their literal in `num`, Id and Assign the interned variable in `sym`,
+// and Op its operator in `op`.
 struct ASTNode {
-    std::string type;
-    std::string value;
+    NodeKind kind;
+    union {
+        int num;
+        Symbol sym;
+        OpKind op;
+    };
     ASTNode* left;
     ASTNode* right;
     ASTNode* third;
     ASTNode* fourth;
 
-    ASTNode(std::string t, std::string v = "", ASTNode* l = nullptr, ASTNode* r = nullptr,
+    ASTNode(NodeKind k, ASTNode* l = nullptr, ASTNode* r = nullptr,
             ASTNode* th = nullptr, ASTNode* f = nullptr)
-        : type(t), value(v), left(l), right(r), third(th), fourth(f) {}
+        : kind(k), num(0), left(l), right(r), third(th), fourth(f) {}
 };
 
 // --- Print AST ---
-void printAST(ASTNode* node, int indent);  // legacy interface
-void printAST(ASTNode* node, const std::string& prefix = "", bool isLast = true);  // tree style
+// Tree style. With flattenLists, each stmt_list spine is shown as one node whose
+// children are its statements in order, which keeps the output linear in program size.
+void printAST(ASTNode* node, const SymbolTable& symbols, std::ostream& out = std::cout,
+              bool flattenLists = false);
 
 // --- AST node creators ---
-ASTNode* createNumNode(int val);
-ASTNode* createIdNode(char* name);
-ASTNode* createOpNode(const std::string& op, ASTNode* l, ASTNode* r);
-ASTNode* createAssignNode(char* name, ASTNode* expr);
-ASTNode* createIfNode(ASTNode* cond, ASTNode* thenStmt, ASTNode* elseStmt);
-ASTNode* createWhileNode(ASTNode* cond, ASTNode* body);
-ASTNode* createForNode(ASTNode* init, ASTNode* cond, ASTNode* inc, ASTNode* body);
-ASTNode* createSwitchNode(ASTNode* expr, ASTNode* cases);
-ASTNode* createCaseNode(int val, ASTNode* body, ASTNode* next);
-ASTNode* createNode(const std::string& type, ASTNode* left, ASTNode* right);
-
-// --- AST root ---
-extern ASTNode* root;
+// Nodes are carved out of `arena` and live until it is reset (normally the AST arena of
+// the compilation's CompilerContext).
+ASTNode* createNumNode(Arena& arena, int val);
+ASTNode* createIdNode(Arena& arena, Symbol name);
+ASTNode* createOpNode(Arena& arena, OpKind op, ASTNode* l, ASTNode* r);
+ASTNode* createAssignNode(Arena& arena, Symbol name, ASTNode* expr);
+ASTNode* createIfNode(Arena& arena, ASTNode* cond, ASTNode* thenStmt, ASTNode* elseStmt);
+ASTNode* createWhileNode(Arena& arena, ASTNode* cond, ASTNode* body);
+ASTNode* createForNode(Arena& arena, ASTNode* init, ASTNode* cond, ASTNode* inc, ASTNode* body);
+ASTNode* createSwitchNode(Arena& arena, ASTNode* expr, ASTNode* cases);
+ASTNode* createCaseNode(Arena& arena, int val, ASTNode* body, ASTNode* next);
+ASTNode* createNode(Arena& arena, NodeKind kind, ASTNode* left, ASTNode* right);
 
-#endif // AST_H
+// --- AST helpers ---
+// Appends the statements of a left-leaning stmt_list spine to `out` in source order,
+// walking the spine iteratively.
+void collectStatements(ASTNode* node, std::vector<ASTNode*>& out);
 
+#endif // AST_H
@@ -0,0 +1,166 @@
+#include "batch.h"
+#include "asm_emitter.h"
+#include "source_file.h"
+#include "thread_pool.h"
+#include "x8086_generator.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+
+namespace {
+
+struct FileResult {
+    bool ok = false;
+    std::size_t bytes = 0;
+    std::size_t quads = 0;
+    std::string messages;  // Diagnostics and I/O errors, one per line
+};
+
+// foo/bar.c -> foo/bar.asm, or <outputDir>/bar.asm.
+std::string outputPathFor(const std::string& input, const std::string& outputDir) {
+    std::size_t slash = input.find_last_of('/');
+    std::size_t nameStart = slash == std::string::npos ? 0 : slash + 1;
+    std::size_t dot = input.find_last_of('.');
+    std::size_t stemEnd = (dot == std::string::npos || dot <= nameStart) ? input.size() : dot;
+    if (outputDir.empty()) return input.substr(0, stemEnd) + ".asm";
+    return outputDir + "/" + input.substr(nameStart, stemEnd - nameStart) + ".asm";
+}
+
+// The file `path` names, spelled one way: `./a.asm`, `a.asm`, `dir//a.asm` and a path
+// through a symbolic link to the same directory all give the same key.
+std::string outputKey(const std::string& path) {
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::absolute(path, error);
+    if (error) return std::filesystem::path(path).lexically_normal().string();
+    // Made absolute first: with no existing prefix to resolve, weakly_canonical would
+    // leave a relative path as it is.
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(absolute, error);
+    return (error ? absolute.lexically_normal() : canonical).string();
+}
+
+bool readManifest(const std::string& path, std::vector<std::string>& inputs, std::string& error) {
+    SourceFile file;
+    if (!file.open(path.c_str(), error)) return false;
+    std::string_view text = file.text();
+    std::size_t pos = 0;
+    while (pos < text.size()) {
+        std::size_t end = text.find('\n', pos);
+        if (end == std::string::npos) end = text.size();
+        std::size_t first = text.find_first_not_of(" \t\r", pos);
+        if (first < end && text[first] != '#') {
+            std::size_t last = text.find_last_not_of(" \t\r", end - 1);
+            inputs.emplace_back(text.substr(first, last - first + 1));
+        }
+        pos = end + 1;
+    }
+    return true;
+}
+
+void compileOne(CompilerContext& ctx, const std::string& input, const std::string& output,
+                const OptimizeOptions& optimize, FileResult& result) {
+    SourceFile source;
+    std::string error;
+    if (!source.open(input.c_str(), error)) {
+        result.messages = error + "\n";
+        return;
+    }
+    result.bytes = source.size();
+
+    bool parsed = ctx.parse(source);
+    if (!parsed || !ctx.root) {
+        result.messages = ctx.diagnostics.text();
+        if (parsed) result.messages += "Parsing succeeded, but AST root is NULL (possibly empty input).\n";
+        return;
+    }
+
+    std::vector<Quad> quads = ctx.generate3AC();
+    if (optimize.any()) {
+        OptimizeStats stats;
+        std::string error;
+        optimizeQuads(quads, optimize, stats, error);
+    }
+    result.quads = quads.size();
+    AsmEmitter out(ctx.symbols, output);
+    out.setDiagnostics(&ctx.diagnostics);
+    if (out.ok()) generate8086(quads, out);
+    result.messages = ctx.diagnostics.text();
+    if (!out.finish()) {
+        result.messages += output + ": could not write assembly\n";
+        return;
+    }
+    result.ok = true;
+}
+
+} // end anonymous namespace
+
+int runBatch(const BatchOptions& options) {
+    std::vector<std::string> inputs = options.inputs;
+    if (!options.manifest.empty()) {
+        std::string error;
+        if (!readManifest(options.manifest, inputs, error)) {
+            fprintf(stderr, "%s: %s\n", options.manifest.c_str(), error.c_str());
+            return 1;
+        }
+    }
+    if (inputs.empty()) {
+        fprintf(stderr, "batch: no input files\n");
+        return 1;
+    }
+
+    // Workers write their outputs independently, so no two inputs may share one.
+    std::vector<std::string> outputs;
+    outputs.reserve(inputs.size());
+    std::unordered_map<std::string, std::size_t> writer;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        outputs.push_back(outputPathFor(inputs[i], options.outputDir));
+        auto [it, inserted] = writer.emplace(outputKey(outputs[i]), i);
+        if (!inserted) {
+            fprintf(stderr, "batch: '%s' and '%s' would both write %s\n",
+                    inputs[it->second].c_str(), inputs[i].c_str(), outputs[i].c_str());
+            return 1;
+        }
+    }
+
+    unsigned jobs = options.jobs ? options.jobs : defaultWorkerCount();
+    if (jobs > inputs.size()) jobs = static_cast<unsigned>(inputs.size());  // No idle workers
+    std::vector<FileResult> results(inputs.size());
+    // One context per worker, reset before each file; keeps the arena's first block warm.
+    std::vector<std::unique_ptr<CompilerContext>> contexts(jobs);
+
+    auto start = std::chrono::steady_clock::now();
+    parallelForEach(inputs.size(), jobs, [&](std::size_t i, unsigned worker) {
+        std::unique_ptr<CompilerContext>& ctx = contexts[worker];
+        if (!ctx) ctx = std::make_unique<CompilerContext>();
+        else ctx->reset();
+        ctx->scannerKind = options.scanner;
+        ctx->parserKind = options.parser;
+        ctx->exprs.setSharing(options.shareExpressions);
+        compileOne(*ctx, inputs[i], outputs[i], options.optimize, results[i]);
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::size_t failed = 0, bytes = 0, quads = 0;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        const FileResult& result = results[i];
+        if (!result.ok) ++failed;
+        bytes += result.bytes;
+        quads += result.quads;
+
+        // Prefix every message line with its input so the report reads like compiler output.
+        std::size_t pos = 0;
+        while (pos < result.messages.size()) {
+            std::size_t end = result.messages.find('\n', pos);
+            if (end == std::string::npos) end = result.messages.size();
+            fprintf(stderr, "%s: %.*s\n", inputs[i].c_str(), (int)(end - pos), result.messages.c_str() + pos);
+            pos = end + 1;
+        }
+    }
+
+    fprintf(stderr, "batch: %zu files (%zu failed), %zu bytes, %zu quads in %.1f ms on %u threads"
+                    " -- %.0f files/s, %.2f MiB/s\n",
+            inputs.size(), failed, bytes, quads, seconds * 1e3, jobs,
+            inputs.size() / seconds, bytes / seconds / (1 << 20));
+    return failed ? 1 : 0;
+}
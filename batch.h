@@ -0,0 +1,25 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "compiler_context.h" // For ScannerKind, ParserKind, OptimizeOptions
+#include <string>
+#include <vector>
+
+struct BatchOptions {
+    std::vector<std::string> inputs;
+    std::string manifest;   // File listing more inputs, one path per line ('#' starts a comment)
+    std::string outputDir;  // Where <name>.asm goes; next to each input when empty
+    unsigned jobs = 0;      // Worker threads; 0 means one per hardware thread
+    ScannerKind scanner = ScannerKind::Builtin;
+    ParserKind parser = ParserKind::Bison;
+    bool shareExpressions = false;  // Hash-cons pure expressions (see ExprFactory)
+    OptimizeOptions optimize;       // Passes run on the quads (see optimizer.h)
+};
+
+// Batch driver (`compiler --batch`): compiles every input on a work-stealing pool, each
+// file in its own context, and writes one .asm per input (foo.c -> foo.asm). Errors are
+// reported per file after the run, followed by one throughput line, all on stderr.
+// Returns 0 if every input compiled, 1 otherwise.
+int runBatch(const BatchOptions& options);
+
+#endif // BATCH_H
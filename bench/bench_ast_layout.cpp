@@ -0,0 +1,157 @@
+// AST traversal throughput: the pointer-linked ASTNode tree against the packed
+// post-order array (packed_ast.h), on one parsed program.
+//
+// Two pointer trees are measured: the parser's own (its nodes sit in the arena in
+// allocation order, which is already fairly local), and a copy whose nodes are put at
+// shuffled places in one block, as a heap that has seen other work would leave them.
+// Each layout is walked depth-first visiting every node, and lowered to 3AC. The
+// packed layout can also be walked as a plain loop over its array.
+//
+// Usage: bench_ast_layout [statements | input_file] [iterations]
+
+#include "bench_util.h"
+#include "compiler_context.h"
+#include "packed_ast.h"
+#include "verbosity.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Copies the tree under `root` into `slots`, one node per slot in a random order.
+ASTNode* scatter(const ASTNode* root, std::vector<ASTNode>& slots, std::size_t nodes) {
+    std::vector<std::size_t> order(nodes);
+    for (std::size_t i = 0; i < nodes; ++i) order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+    slots.assign(nodes, ASTNode(NodeKind::Break));
+
+    std::size_t used = 0;
+    std::vector<std::pair<const ASTNode*, ASTNode**>> stack;
+    ASTNode* copyRoot = nullptr;
+    stack.push_back({root, &copyRoot});
+    while (!stack.empty()) {
+        auto [node, link] = stack.back();
+        stack.pop_back();
+        ASTNode* copy = &slots[order[used++]];
+        std::memcpy(static_cast<void*>(copy), node, sizeof(ASTNode));
+        *link = copy;
+        if (node->left) stack.push_back({node->left, &copy->left});
+        if (node->right) stack.push_back({node->right, &copy->right});
+        if (node->third) stack.push_back({node->third, &copy->third});
+        if (node->fourth) stack.push_back({node->fourth, &copy->fourth});
+    }
+    return copyRoot;
+}
+
+// Depth-first walk visiting every node; returns a checksum so the work is not dropped.
+template <typename Node>
+long walk(Node root) {
+    long sum = 0;
+    std::vector<Node> stack{root};
+    while (!stack.empty()) {
+        Node node = stack.back();
+        stack.pop_back();
+        sum += static_cast<long>(node.kind()) + (node.kind() == NodeKind::Num ? node.num() : 0);
+        if (node.left()) stack.push_back(node.left());
+        if (node.right()) stack.push_back(node.right());
+        if (node.third()) stack.push_back(node.third());
+        if (node.fourth()) stack.push_back(node.fourth());
+    }
+    return sum;
+}
+
+long scan(const PackedAST& ast) {
+    long sum = 0;
+    for (const PackedNode& node : ast.nodes)
+        sum += static_cast<long>(node.kind) + (node.kind == NodeKind::Num ? node.payload : 0);
+    return sum;
+}
+
+bool sameOperand(const Operand& a, const Operand& b) {
+    return a.kind == b.kind && a.value == b.value;
+}
+
+bool sameQuads(const std::vector<Quad>& a, const std::vector<Quad>& b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i].op != b[i].op || !sameOperand(a[i].arg1, b[i].arg1) || !sameOperand(a[i].arg2, b[i].arg2) ||
+            !sameOperand(a[i].result, b[i].result))
+            return false;
+    }
+    return true;
+}
+
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+    verbosityLevel = VERBOSITY_QUIET;
+    const char* arg = argc > 1 ? argv[1] : "500000";
+    int iterations = argc > 2 ? atoi(argv[2]) : 5;
+
+    std::string source;
+    if (!loadInput(arg, source, [](const char* size) { return mixedStatements(atol(size)); })) return 1;
+
+    CompilerContext ctx;
+    if (!ctx.parse(source) || !ctx.root) {
+        fprintf(stderr, "bench_ast_layout: input does not parse:\n%s", ctx.diagnostics.text().c_str());
+        return 1;
+    }
+
+    PackedAST packed;
+    double packSeconds = best(iterations, [&] { packAST(ctx.root, packed); });
+    std::size_t nodes = packed.nodes.size();
+    std::vector<ASTNode> slots;
+    ASTNode* scattered = scatter(ctx.root, slots, nodes);
+
+    long expected = walk(TreeNodeRef(ctx.root));
+    if (walk(TreeNodeRef(scattered)) != expected || walk(packedRoot(packed.view())) != expected || scan(packed) != expected) {
+        fprintf(stderr, "bench_ast_layout: layouts disagree\n");
+        return 1;
+    }
+
+    std::vector<Quad> reference, quads;
+    TACState state;
+    generate3AC(ctx.root, state, reference);
+    state = TACState();
+    generate3AC(packed.view(), state, quads);
+    if (!sameQuads(reference, quads)) {
+        fprintf(stderr, "bench_ast_layout: lowering the packed AST gave different quads\n");
+        return 1;
+    }
+
+    std::size_t treeBytes = nodes * sizeof(ASTNode);
+    std::size_t packedBytes = nodes * sizeof(PackedNode) + packed.extras.size() * sizeof(packed.extras[0]);
+    fprintf(stderr, "bench_ast_layout: %zu nodes, tree %.1f MB, packed %.1f MB (packing %.1f ms), best of %d runs\n",
+            nodes, treeBytes / 1e6, packedBytes / 1e6, packSeconds * 1e3, iterations);
+    fprintf(stderr, "%-18s %12s %12s\n", "layout", "walk ns/node", "3AC ns/node");
+
+    long sink = 0;
+    auto row = [&](const char* name, double walkSeconds, double lowerSeconds) {
+        if (lowerSeconds > 0)
+            fprintf(stderr, "%-18s %12.2f %12.2f\n", name, walkSeconds / nodes * 1e9, lowerSeconds / nodes * 1e9);
+        else
+            fprintf(stderr, "%-18s %12.2f %12s\n", name, walkSeconds / nodes * 1e9, "-");
+    };
+    auto lower = [&](auto&& fn) {
+        return best(iterations, [&] {
+            quads.clear();
+            state = TACState();
+            fn();
+        });
+    };
+
+    row("tree (arena)", best(iterations, [&] { sink += walk(TreeNodeRef(ctx.root)); }),
+        lower([&] { generate3AC(ctx.root, state, quads); }));
+    row("tree (scattered)", best(iterations, [&] { sink += walk(TreeNodeRef(scattered)); }),
+        lower([&] { generate3AC(scattered, state, quads); }));
+    row("packed", best(iterations, [&] { sink += walk(packedRoot(packed.view())); }),
+        lower([&] { generate3AC(packed.view(), state, quads); }));
+    row("packed (scan)", best(iterations, [&] { sink += scan(packed); }), 0);
+    return sink == 42 ? 2 : 0;
+}
@@ -0,0 +1,63 @@
+// Control-flow graph construction time (buildCFG, see cfg.h) on the quads of one large
+// program. The default size lowers to a few million quads. The graph is built into
+// fresh storage and into a reused ControlFlowGraph, and walked in reverse postorder.
+//
+// Usage: bench_cfg [statements | input_file] [iterations]
+
+#include "bench_util.h"
+#include "cfg.h"
+#include "compiler_context.h"
+#include "verbosity.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    verbosityLevel = VERBOSITY_QUIET;
+    const char* arg = argc > 1 ? argv[1] : "400000";
+    int iterations = argc > 2 ? atoi(argv[2]) : 5;
+
+    std::string source;
+    if (!loadInput(arg, source, [](const char* size) { return mixedStatements(atol(size)); })) return 1;
+
+    CompilerContext ctx;
+    if (!ctx.parse(source) || !ctx.root) {
+        fprintf(stderr, "bench_cfg: input does not parse:\n%s", ctx.diagnostics.text().c_str());
+        return 1;
+    }
+    std::vector<Quad> quads = ctx.generate3AC();
+
+    ControlFlowGraph cfg;
+    std::string error;
+    if (!buildCFG(quads, cfg, error)) {
+        fprintf(stderr, "bench_cfg: %s\n", error.c_str());
+        return 1;
+    }
+    fprintf(stderr, "bench_cfg: %zu quads, %zu blocks, %zu edges, %zu reachable, best of %d runs\n",
+            quads.size(), cfg.blocks.size(), cfg.edgeCount(), cfg.reversePostorder.size(), iterations);
+
+    double fresh = best(iterations, [&] {
+        ControlFlowGraph graph;
+        buildCFG(quads, graph, error);
+    });
+    double reused = best(iterations, [&] { buildCFG(quads, cfg, error); });
+    long sink = 0;
+    double walk = best(iterations, [&] {
+        for (std::uint32_t b : cfg.reversePostorder) {
+            for (std::uint32_t p : cfg.predecessors(b)) sink += p;
+            sink += cfg.blocks[b].last - cfg.blocks[b].first;
+        }
+    });
+
+    fprintf(stderr, "%-22s %10s %12s\n", "", "ms", "ns/quad");
+    auto row = [&](const char* name, double seconds) {
+        fprintf(stderr, "%-22s %10.2f %12.2f\n", name, seconds * 1e3, seconds / quads.size() * 1e9);
+    };
+    row("build (fresh)", fresh);
+    row("build (reused)", reused);
+    row("walk (reverse post.)", walk);
+    return sink == 42 ? 2 : 0;
+}
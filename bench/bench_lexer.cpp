@@ -0,0 +1,101 @@
+// Scanner throughput: the flex scanner from lexer.l against the hand-written Scanner at
+// each SIMD level, on one large input, and lexTokens() filling a TokenBuffer on 1 .. N
+// threads. Only tokens are produced (no parsing), with logging off, so the numbers are
+// the cost of lexing alone.
+//
+// Usage: bench_lexer [megabytes | input_file] [iterations] [max_threads]
+
+#include "bench_util.h"
+#include "compiler_context.h"
+#include "thread_pool.h"
+#include "verbosity.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+// Roughly what generated programs look like: indented blocks, long identifiers, loops.
+std::string buildSource(std::size_t bytes) {
+    std::string text;
+    text.reserve(bytes + 256);
+    for (int i = 0; text.size() < bytes; ++i) {
+        text += "counter_" + std::to_string(i % 97) + " = counter_" + std::to_string(i % 89) + " + " +
+                std::to_string(i) + ";\n";
+        if (i % 5 == 0) text += "if (value_total >= 1000) {\n        value_total = value_total - 1;\n}\n";
+        if (i % 11 == 0) text += "while (i < 10) { i++; }\n\n";
+    }
+    return text;
+}
+
+void report(const char* name, std::size_t tokens, std::size_t bytes, double seconds) {
+    fprintf(stderr, "%-14s %12zu %10.1f %14.1f %10.1f\n", name, tokens, seconds * 1e3,
+            tokens / seconds / 1e6, bytes / seconds / (1 << 20));
+}
+
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+    verbosityLevel = VERBOSITY_QUIET;
+    const char* arg = argc > 1 ? argv[1] : "64";
+    int iterations = argc > 2 ? atoi(argv[2]) : 3;
+    unsigned maxThreads = argc > 3 ? static_cast<unsigned>(atoi(argv[3])) : defaultWorkerCount();
+
+    std::string source;
+    if (!loadInput(arg, source, [](const char* size) { return buildSource(static_cast<std::size_t>(atof(size) * (1 << 20))); })) return 1;
+    // flex scans in place and needs two NULs after the text.
+    std::string flexBuffer = source + std::string(2, '\0');
+
+    fprintf(stderr, "bench_lexer: %zu bytes, best of %d runs\n", source.size(), iterations);
+    fprintf(stderr, "%-14s %12s %10s %14s %10s\n", "scanner", "tokens", "ms", "Mtokens/s", "MiB/s");
+
+    YYSTYPE value;
+    {
+        double fastest = 1e30;
+        std::size_t tokens = 0;
+        for (int i = 0; i < iterations; ++i) {
+            CompilerContext ctx;
+            auto start = std::chrono::steady_clock::now();
+            flexBeginBuffer(&flexBuffer[0], source.size());
+            tokens = 0;
+            while (flexLex(&value, &ctx)) ++tokens;
+            flexEndSource();
+            double seconds = elapsedSeconds(start);
+            if (seconds < fastest) fastest = seconds;
+        }
+        report("flex", tokens, source.size(), fastest);
+    }
+
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        if (static_cast<int>(level) > static_cast<int>(detectSimdLevel())) break;
+        double fastest = 1e30;
+        std::size_t tokens = 0;
+        for (int i = 0; i < iterations; ++i) {
+            CompilerContext ctx;
+            ctx.scanner.setSimdLevel(level);
+            auto start = std::chrono::steady_clock::now();
+            ctx.scanner.reset(source);
+            tokens = 0;
+            while (ctx.scanner.next(value, ctx.symbols, ctx.diagnostics)) ++tokens;
+            double seconds = elapsedSeconds(start);
+            if (seconds < fastest) fastest = seconds;
+        }
+        std::string name = std::string("builtin/") + simdLevelName(level);
+        report(name.c_str(), tokens, source.size(), fastest);
+    }
+
+    TokenBuffer tokens;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        double fastest = 1e30;
+        for (int i = 0; i < iterations; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            lexTokens(source, tokens, threads);
+            double seconds = elapsedSeconds(start);
+            if (seconds < fastest) fastest = seconds;
+        }
+        std::string name = "prelexed/" + std::to_string(threads);
+        report(name.c_str(), tokens.size(), source.size(), fastest);
+    }
+    return 0;
+}
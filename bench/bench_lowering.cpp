@@ -0,0 +1,70 @@
+// Micro-benchmark for the 3AC lowering pass.
+// Builds a synthetic program directly through the AST creators (no lexer/parser involved)
+// and reports the average cost of generate3AC per AST node.
+//
+// Usage: bench_lowering [statements] [expression_depth] [iterations]
+
+#include "compiler_context.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+static CompilerContext ctx;
+
+static const OpKind kOps[] = {OpKind::Add, OpKind::Sub, OpKind::Mul, OpKind::Lt, OpKind::Eq, OpKind::Mod};
+
+static size_t nodeCount = 0;
+
+static ASTNode* count(ASTNode* node) {
+    ++nodeCount;
+    return node;
+}
+
+// Left-leaning chain of binary operators, `depth` operators deep.
+static ASTNode* buildExpr(int depth, Symbol a, Symbol b) {
+    ASTNode* expr = count(createIdNode(ctx.astArena, a));
+    for (int i = 0; i < depth; ++i) {
+        ASTNode* rhs = (i % 2) ? count(createIdNode(ctx.astArena, b)) : count(createNumNode(ctx.astArena, i));
+        expr = count(createOpNode(ctx.astArena, kOps[i % 6], expr, rhs));
+    }
+    return expr;
+}
+
+static ASTNode* buildStmt(int i, int depth, Symbol a, Symbol b) {
+    ASTNode* assign = count(createAssignNode(ctx.astArena, a, buildExpr(depth, a, b)));
+    switch (i % 8) {
+        case 3: return count(createIfNode(ctx.astArena, buildExpr(2, a, b), assign, nullptr));
+        case 5: return count(createWhileNode(ctx.astArena, buildExpr(2, b, a), assign));
+        case 7: return count(createNode(ctx.astArena, NodeKind::StmtList, assign,
+                                        count(createOpNode(ctx.astArena, OpKind::PostInc, count(createIdNode(ctx.astArena, b)), nullptr))));
+        default: return assign;
+    }
+}
+
+int main(int argc, char** argv) {
+    int statements = argc > 1 ? atoi(argv[1]) : 20000;
+    int depth = argc > 2 ? atoi(argv[2]) : 16;
+    int iterations = argc > 3 ? atoi(argv[3]) : 20;
+
+    Symbol a = ctx.symbols.intern("a");
+    Symbol b = ctx.symbols.intern("b");
+
+    ASTNode* root = buildStmt(0, depth, a, b);
+    for (int i = 1; i < statements; ++i) {
+        root = count(createNode(ctx.astArena, NodeKind::StmtList, root, buildStmt(i, depth, a, b)));
+    }
+
+    size_t quadCount = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        quadCount = generate3AC(root).size();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    fprintf(stderr, "bench_lowering: %d statements, depth %d, %zu nodes, %zu quads\n",
+            statements, depth, nodeCount, quadCount);
+    fprintf(stderr, "bench_lowering: %.2f ns/node, %.2f ms/iteration\n",
+            elapsed / iterations / nodeCount, elapsed / iterations / 1e6);
+    return 0;
+}
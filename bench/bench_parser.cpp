@@ -0,0 +1,66 @@
+// Parser throughput: the bison parser from parser.y against the hand-written descent
+// parser, on one large program. Both read tokens from the builtin scanner, whose cost
+// is measured on its own first and shown subtracted in the last column, so that column
+// is the cost of parsing and building the AST alone.
+//
+// Usage: bench_parser [statements | input_file] [iterations]
+
+#include "bench_util.h"
+#include "compiler_context.h"
+#include "verbosity.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    verbosityLevel = VERBOSITY_QUIET;
+    const char* arg = argc > 1 ? argv[1] : "500000";
+    int iterations = argc > 2 ? atoi(argv[2]) : 3;
+
+    std::string source;
+    if (!loadInput(arg, source, [](const char* size) { return mixedStatements(atol(size)); })) return 1;
+
+    CompilerContext ctx;
+
+    // Lexing alone, to separate it from the parsers' own cost.
+    double lexBest = 1e30;
+    for (int i = 0; i < iterations; ++i) {
+        ctx.reset();
+        YYSTYPE value;
+        auto start = std::chrono::steady_clock::now();
+        ctx.scanner.reset(source);
+        while (ctx.scanner.next(value, ctx.symbols, ctx.diagnostics)) {}
+        double seconds = elapsedSeconds(start);
+        if (seconds < lexBest) lexBest = seconds;
+    }
+
+    // Top-level statements (nested ones are not counted).
+    ctx.reset();
+    if (!ctx.parse(source) || !ctx.root) {
+        fprintf(stderr, "bench_parser: input does not parse:\n%s", ctx.diagnostics.text().c_str());
+        return 1;
+    }
+    std::vector<ASTNode*> statements;
+    collectStatements(ctx.root, statements);
+
+    fprintf(stderr, "bench_parser: %zu bytes, %zu statements, best of %d runs (lexing alone %.1f ms)\n",
+            source.size(), statements.size(), iterations, lexBest * 1e3);
+    fprintf(stderr, "%-10s %10s %14s %18s\n", "parser", "ms", "Mstatements/s", "parse-only ns/st");
+
+    for (ParserKind kind : {ParserKind::Bison, ParserKind::Descent}) {
+        double fastest = 1e30;
+        for (int i = 0; i < iterations; ++i) {
+            ctx.reset();
+            ctx.parserKind = kind;
+            auto start = std::chrono::steady_clock::now();
+            ctx.parse(source);
+            double seconds = elapsedSeconds(start);
+            if (seconds < fastest) fastest = seconds;
+        }
+        fprintf(stderr, "%-10s %10.1f %14.2f %18.1f\n", kind == ParserKind::Bison ? "bison" : "descent", fastest * 1e3,
+                statements.size() / fastest / 1e6, (fastest - lexBest) / statements.size() * 1e9);
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Stress benchmark for very long statement lists.
+// Builds left-leaning stmt_list spines like the parser does (N, 2N and 4N statements),
+// then lowers and prints them on a thread with a deliberately small stack. Finishing at all
+// shows stack use is bounded; the ns/statement column staying flat shows the passes are linear.
+//
+// Usage: bench_stress [statements] [stack_kib]
+
+#include "compiler_context.h"
+#include <pthread.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <streambuf>
+
+namespace {
+
+struct NullBuffer : std::streambuf {
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+int baseStatements = 1000000;
+
+double elapsedNs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+// x = x + i;  with every fourth statement wrapped in an if and every seventh a ++.
+ASTNode* buildProgram(Arena& arena, int statements, Symbol x, Symbol y) {
+    ASTNode* program = nullptr;
+    for (int i = 0; i < statements; ++i) {
+        ASTNode* stmt = createAssignNode(arena, x, createOpNode(arena, OpKind::Add, createIdNode(arena, x), createNumNode(arena, i)));
+        if (i % 4 == 3) stmt = createIfNode(arena, createOpNode(arena, OpKind::Lt, createIdNode(arena, x), createIdNode(arena, y)), stmt, nullptr);
+        if (i % 7 == 6) stmt = createOpNode(arena, OpKind::PostInc, createIdNode(arena, y), nullptr);
+        program = program ? createNode(arena, NodeKind::StmtList, program, stmt) : stmt;
+    }
+    return program;
+}
+
+void* run(void*) {
+    CompilerContext ctx;
+    NullBuffer nullBuffer;
+    std::streambuf* saved = std::cout.rdbuf(&nullBuffer);
+
+    double results[3][3];
+    size_t quadCounts[3];
+    for (int round = 0; round < 3; ++round) {
+        int statements = baseStatements << round;
+        Symbol x = ctx.symbols.intern("x");
+        Symbol y = ctx.symbols.intern("y");
+
+        auto start = std::chrono::steady_clock::now();
+        ctx.root = buildProgram(ctx.astArena, statements, x, y);
+        results[round][0] = elapsedNs(start) / statements;
+
+        start = std::chrono::steady_clock::now();
+        quadCounts[round] = generate3AC(ctx.root).size();
+        results[round][1] = elapsedNs(start) / statements;
+
+        start = std::chrono::steady_clock::now();
+        printAST(ctx.root, ctx.symbols, std::cout, true);
+        results[round][2] = elapsedNs(start) / statements;
+
+        ctx.reset();
+    }
+
+    std::cout.rdbuf(saved);
+    fprintf(stderr, "%12s %10s %12s %12s %12s\n", "statements", "quads", "build ns/st", "lower ns/st", "print ns/st");
+    for (int round = 0; round < 3; ++round) {
+        fprintf(stderr, "%12d %10zu %12.1f %12.1f %12.1f\n", baseStatements << round, quadCounts[round],
+                results[round][0], results[round][1], results[round][2]);
+    }
+    return nullptr;
+}
+
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+    baseStatements = argc > 1 ? atoi(argv[1]) : 1000000;
+    size_t stackKiB = argc > 2 ? strtoul(argv[2], nullptr, 10) : 256;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, stackKiB * 1024);
+    pthread_t thread;
+    if (pthread_create(&thread, &attr, run, nullptr) != 0) {
+        fprintf(stderr, "bench_stress: could not start worker thread\n");
+        return 1;
+    }
+    pthread_join(thread, nullptr);
+    pthread_attr_destroy(&attr);
+    fprintf(stderr, "bench_stress: completed on a %zu KiB stack\n", stackKiB);
+    return 0;
+}
@@ -0,0 +1,67 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+// Helpers shared by the benchmarks in this directory (header only; each benchmark is a
+// single translation unit linked against the compiler library).
+
+#include "source_file.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <sys/stat.h>
+
+// Top-level statements of roughly the shapes the web editor sees: assignments with
+// mixed precedence, conditionals, loops and the occasional switch.
+inline std::string mixedStatements(long statements) {
+    std::string text;
+    for (long i = 0; i < statements; ++i) {
+        std::string n = std::to_string(i);
+        switch (i % 6) {
+            case 0: text += "total = total + value_" + std::to_string(i % 31) + " * 3 - " + n + ";\n"; break;
+            case 1: text += "if (total >= " + n + ") {\n    total = total - 1;\n} else\n    count++;\n"; break;
+            case 2: text += "while (i < 10 == flag) { i = (i + 1) % 7; }\n"; break;
+            case 3: text += "for (; i < " + n + "; i++) sum = sum + i / 2;\n"; break;
+            case 4: text += "switch (mode) { case 1: a = 1; break; case 2: a = 2; break; default: a = 0; }\n"; break;
+            default: text += "--count;\n"; break;
+        }
+    }
+    return text;
+}
+
+// The benchmark's input: the file `arg` names if there is one, else what `build` makes
+// of `arg` (a size). Returns false, having said why, if the file cannot be read.
+template <typename Build>
+bool loadInput(const char* arg, std::string& source, Build build) {
+    struct stat st;
+    if (stat(arg, &st) != 0) {
+        source = build(arg);
+        return true;
+    }
+    SourceFile file;
+    std::string error;
+    if (!file.open(arg, error)) {
+        fprintf(stderr, "%s: %s\n", arg, error.c_str());
+        return false;
+    }
+    source = std::string(file.text());
+    return true;
+}
+
+inline double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Fastest of `iterations` runs of `fn`, in seconds.
+template <typename Fn>
+double best(int iterations, Fn fn) {
+    double result = 1e30;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        result = std::min(result, elapsedSeconds(start));
+    }
+    return result;
+}
+
+#endif // BENCH_UTIL_H
@@ -0,0 +1,199 @@
+#include "cfg.h"
+#include "verbosity.h"
+#include <algorithm>
+
+static bool isJump(QuadOp op) {
+    return op == QuadOp::Goto || op == QuadOp::If || op == QuadOp::IfFalse;
+}
+
+static bool fail(std::string& error, std::size_t quad, const std::string& reason) {
+    error = "quad " + std::to_string(quad) + ": " + reason;
+    return false;
+}
+
+bool buildCFG(const std::vector<Quad>& quads, ControlFlowGraph& cfg, std::string& error) {
+    return buildCFG(quads.data(), quads.size(), cfg, error);
+}
+
+bool buildCFG(const Quad* quads, std::size_t count, ControlFlowGraph& cfg, std::string& error) {
+    cfg.quads = quads;
+    cfg.quadCount = count;
+    cfg.blocks.clear();
+    cfg.predecessorList.clear();
+    cfg.labelBlocks.clear();
+    cfg.reversePostorder.clear();
+    if (count >= kNoBlock) return fail(error, count, "too many quads for a control-flow graph");
+
+    // Pass 1: split into blocks and note which block each label starts.
+    int maxLabel = -1;
+    for (std::size_t i = 0; i < count; ++i) {
+        const Quad& q = quads[i];
+        if (q.op != QuadOp::Label && !isJump(q.op)) continue;
+        if (q.result.kind != OperandKind::Label || q.result.value < 0)
+            return fail(error, i, std::string(quadOpText(q.op)) + " without a label operand");
+        maxLabel = std::max(maxLabel, q.result.value);
+    }
+    cfg.labelBlocks.assign(static_cast<std::size_t>(maxLabel + 1), kNoBlock);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Quad& q = quads[i];
+        bool startsBlock = i == 0 || isJump(quads[i - 1].op) ||
+                           (q.op == QuadOp::Label && quads[i - 1].op != QuadOp::Label);
+        if (startsBlock) {
+            if (!cfg.blocks.empty()) cfg.blocks.back().last = static_cast<std::uint32_t>(i);
+            cfg.blocks.push_back({static_cast<std::uint32_t>(i), 0, {kNoBlock, kNoBlock}, 0, 0, 0});
+        }
+        if (q.op == QuadOp::Label) {
+            std::uint32_t& block = cfg.labelBlocks[q.result.value];
+            if (block != kNoBlock) return fail(error, i, "label L" + std::to_string(q.result.value) + " placed twice");
+            block = static_cast<std::uint32_t>(cfg.blocks.size() - 1);
+        }
+    }
+    if (!cfg.blocks.empty()) cfg.blocks.back().last = static_cast<std::uint32_t>(count);
+
+    // Pass 2: edges. Successors come from each block's last quad; predecessors are then
+    // laid out block by block in one array (counted first, so it is sized exactly).
+    std::vector<std::uint32_t> predecessorCounts(cfg.blocks.size() + 1, 0);
+    for (std::uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+        BasicBlock& block = cfg.blocks[b];
+        std::size_t lastQuad = block.last - 1;
+        const Quad& q = quads[lastQuad];
+        std::uint32_t next = b + 1 < cfg.blocks.size() ? b + 1 : kNoBlock;
+        std::uint32_t target = kNoBlock;
+        if (isJump(q.op)) {
+            target = cfg.labelBlocks[q.result.value];
+            if (target == kNoBlock)
+                return fail(error, lastQuad, "jump to label L" + std::to_string(q.result.value) + ", which is never placed");
+        }
+        if (q.op != QuadOp::Goto && next != kNoBlock) block.successors[block.successorCount++] = next;
+        if (target != kNoBlock && target != next) block.successors[block.successorCount++] = target;
+        if (q.op == QuadOp::Goto && target == next) block.successors[block.successorCount++] = target;
+        for (std::uint32_t s : cfg.successors(b)) ++predecessorCounts[s + 1];
+    }
+    for (std::size_t b = 0; b < cfg.blocks.size(); ++b) {
+        predecessorCounts[b + 1] += predecessorCounts[b];
+        cfg.blocks[b].predecessorBegin = cfg.blocks[b].predecessorEnd = predecessorCounts[b];
+    }
+    cfg.predecessorList.resize(predecessorCounts[cfg.blocks.size()]);
+    for (std::uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+        for (std::uint32_t s : cfg.successors(b)) cfg.predecessorList[cfg.blocks[s].predecessorEnd++] = b;
+    }
+
+    // Pass 3: reverse postorder of the blocks reachable from the entry (iterative DFS).
+    if (cfg.blocks.empty()) return true;
+    std::vector<std::uint8_t> visited(cfg.blocks.size(), 0);
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> stack;  // Block, successors done
+    stack.push_back({0, 0});
+    visited[0] = 1;
+    while (!stack.empty()) {
+        auto& [b, done] = stack.back();
+        if (done < cfg.blocks[b].successorCount) {
+            std::uint32_t s = cfg.blocks[b].successors[done++];
+            if (!visited[s]) {
+                visited[s] = 1;
+                stack.push_back({s, 0});
+            }
+        } else {
+            cfg.reversePostorder.push_back(b);
+            stack.pop_back();
+        }
+    }
+    std::reverse(cfg.reversePostorder.begin(), cfg.reversePostorder.end());
+    LOG_DEBUG("DEBUG: buildCFG - %zu quads, %zu blocks, %zu edges, %zu reachable.\n",
+              count, cfg.blocks.size(), cfg.edgeCount(), cfg.reversePostorder.size());
+    return true;
+}
+
+// --- Dominators ---
+
+std::vector<std::uint32_t> immediateDominators(const ControlFlowGraph& cfg) {
+    std::vector<std::uint32_t> idom(cfg.blocks.size(), kNoBlock);
+    if (cfg.reversePostorder.empty()) return idom;
+    std::vector<std::uint32_t> order(cfg.blocks.size(), kNoBlock);  // Block -> reverse postorder index
+    for (std::uint32_t i = 0; i < cfg.reversePostorder.size(); ++i) order[cfg.reversePostorder[i]] = i;
+
+    // The entry is its own dominator while iterating, which ends every walk up the tree.
+    std::uint32_t entry = cfg.reversePostorder[0];
+    idom[entry] = entry;
+    auto intersect = [&](std::uint32_t a, std::uint32_t b) {
+        while (a != b) {
+            while (order[a] > order[b]) a = idom[a];
+            while (order[b] > order[a]) b = idom[b];
+        }
+        return a;
+    };
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (std::size_t i = 1; i < cfg.reversePostorder.size(); ++i) {
+            std::uint32_t b = cfg.reversePostorder[i];
+            std::uint32_t dominator = kNoBlock;
+            for (std::uint32_t p : cfg.predecessors(b)) {
+                if (idom[p] == kNoBlock) continue;  // Not processed yet, or unreachable
+                dominator = dominator == kNoBlock ? p : intersect(p, dominator);
+            }
+            if (idom[b] != dominator) {
+                idom[b] = dominator;
+                changed = true;
+            }
+        }
+    }
+    idom[entry] = kNoBlock;
+    return idom;
+}
+
+// --- Printing ---
+
+static std::vector<bool> reachableBlocks(const ControlFlowGraph& cfg) {
+    std::vector<bool> reachable(cfg.blocks.size(), false);
+    for (std::uint32_t b : cfg.reversePostorder) reachable[b] = true;
+    return reachable;
+}
+
+void printCFG(const ControlFlowGraph& cfg, const SymbolTable& symbols, std::ostream& out) {
+    out << "--- Control-Flow Graph (" << cfg.blocks.size() << " blocks, " << cfg.edgeCount() << " edges) ---\n";
+    std::vector<bool> reachable = reachableBlocks(cfg);
+    for (std::uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+        const BasicBlock& block = cfg.blocks[b];
+        out << "B" << b << " (quads " << block.first << "-" << block.last - 1 << ")";
+        if (cfg.predecessors(b).size()) {
+            out << " <-";
+            for (std::uint32_t p : cfg.predecessors(b)) out << " B" << p;
+        }
+        if (cfg.successors(b).size()) {
+            out << " ->";
+            for (std::uint32_t s : cfg.successors(b)) out << " B" << s;
+        }
+        if (!reachable[b]) out << " unreachable";
+        out << "\n";
+        for (std::uint32_t i = block.first; i < block.last; ++i) out << "    " << quadText(cfg.quads[i], symbols) << "\n";
+    }
+    out << "-----------------------------------" << std::endl;
+}
+
+void printCFGDot(const ControlFlowGraph& cfg, const SymbolTable& symbols, std::ostream& out) {
+    out << "digraph cfg {\n";
+    out << "    node [shape=box, fontname=\"monospace\"];\n";
+    std::vector<bool> reachable = reachableBlocks(cfg);
+    for (std::uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+        const BasicBlock& block = cfg.blocks[b];
+        out << "    B" << b << " [label=\"B" << b << "\\l";
+        for (std::uint32_t i = block.first; i < block.last; ++i) {
+            for (char c : quadText(cfg.quads[i], symbols)) {
+                if (c == '"' || c == '\\') out << '\\';
+                out << c;
+            }
+            out << "\\l";
+        }
+        out << "\"" << (reachable[b] ? "" : ", style=dashed") << "];\n";
+    }
+    for (std::uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+        const Quad& last = cfg.quads[cfg.blocks[b].last - 1];
+        std::uint32_t target = isJump(last.op) ? cfg.blockOf(last.result) : kNoBlock;
+        for (std::uint32_t s : cfg.successors(b)) {
+            out << "    B" << b << " -> B" << s;
+            // A conditional jump to the very next block is drawn as the jump.
+            if (s == target) out << " [style=dashed]";
+            out << ";\n";
+        }
+    }
+    out << "}" << std::endl;
+}
@@ -0,0 +1,88 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include "three_address_code.h" // For Quad
+#include "symbol_table.h"       // For SymbolTable
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// --- Control-flow graph ---
+// The quads of a program, split into basic blocks: straight-line runs that are only
+// entered at their first quad and only left after their last. A block starts at the
+// first quad, at a label (a run of consecutive labels starts one block) and after
+// every goto, if and ifFalse. Label operands are resolved to blocks once, while the
+// graph is built, so the passes working on it never look a label up again.
+//
+// The graph does not own the quads. It keeps indices into them, and it stays valid only
+// while the quads stay where they are and keep their control flow.
+
+constexpr std::uint32_t kNoBlock = UINT32_MAX;
+
+struct BasicBlock {
+    std::uint32_t first;  // Index of the block's first quad
+    std::uint32_t last;   // One past its last quad
+    // Where control can go next: the next block if control can fall through (for a
+    // conditional jump, the branch not taken), then the jump target. A conditional jump
+    // to the next block gives one successor, and the last block may have none.
+    std::uint32_t successors[2];
+    std::uint32_t successorCount;
+    std::uint32_t predecessorBegin;  // Range of this block's predecessors in
+    std::uint32_t predecessorEnd;    // ControlFlowGraph::predecessorList
+};
+
+// Block numbers stored anywhere (successor slots, predecessor lists, orders).
+struct BlockList {
+    const std::uint32_t* first;
+    const std::uint32_t* last;
+    const std::uint32_t* begin() const { return first; }
+    const std::uint32_t* end() const { return last; }
+    std::size_t size() const { return last - first; }
+};
+
+struct ControlFlowGraph {
+    const Quad* quads = nullptr;
+    std::size_t quadCount = 0;
+    std::vector<BasicBlock> blocks;             // In quad order; block 0 is the entry
+    std::vector<std::uint32_t> predecessorList; // Every block's predecessors, block by block
+    std::vector<std::uint32_t> labelBlocks;     // Label number -> block it starts (kNoBlock if none)
+    std::vector<std::uint32_t> reversePostorder;// Blocks reachable from the entry, in reverse postorder
+
+    std::size_t edgeCount() const { return predecessorList.size(); }
+    BlockList successors(std::uint32_t block) const {
+        const BasicBlock& b = blocks[block];
+        return {b.successors, b.successors + b.successorCount};
+    }
+    BlockList predecessors(std::uint32_t block) const {
+        const BasicBlock& b = blocks[block];
+        return {predecessorList.data() + b.predecessorBegin, predecessorList.data() + b.predecessorEnd};
+    }
+    // Block that `label` (a Label operand) starts.
+    std::uint32_t blockOf(const Operand& label) const { return labelBlocks[label.value]; }
+};
+
+// Builds the graph of `count` quads into `cfg`, reusing its storage. Quads from the
+// lowering pass always form a graph; a hand-written listing (see parse3AC) may not, so a
+// jump to a label that is never placed, or a label placed twice, makes it return false
+// with `error` set to "quad N: ...".
+bool buildCFG(const Quad* quads, std::size_t count, ControlFlowGraph& cfg, std::string& error);
+bool buildCFG(const std::vector<Quad>& quads, ControlFlowGraph& cfg, std::string& error);
+
+// Immediate dominator of every block, by the iterative algorithm of Cooper, Harvey and
+// Kennedy over the reverse postorder: the last block before `b` on every path from the
+// entry to `b`. kNoBlock for the entry and for blocks the entry cannot reach.
+std::vector<std::uint32_t> immediateDominators(const ControlFlowGraph& cfg);
+
+// Lists every block with its edges and quads:
+//   B1 (quads 3-7) <- B0 B4 -> B2 B5
+//       t1 = a < b
+//       ...
+// Blocks the entry cannot reach are marked "unreachable".
+void printCFG(const ControlFlowGraph& cfg, const SymbolTable& symbols, std::ostream& out);
+// The same graph in Graphviz form (`dot -Tsvg`): one box per block listing its quads,
+// fall-through edges solid, jump edges and unreachable blocks dashed.
+void printCFGDot(const ControlFlowGraph& cfg, const SymbolTable& symbols, std::ostream& out);
+
+#endif // CFG_H
@@ -0,0 +1,141 @@
+#include "compiler_context.h"
+#include "descent_parser.h"
+#include "x8086_generator.h"
+#include "asm_emitter.h"
+#include <mutex>
+#include <sstream>
+
+static std::mutex& flexMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+// Called by the pure parser for each token.
+int yylex(YYSTYPE* value, CompilerContext* ctx) {
+    if (ctx->scannerKind == ScannerKind::Flex) return flexLex(value, ctx);
+    if (ctx->scannerKind == ScannerKind::Prelexed) return ctx->nextBufferedToken(*value);
+    return ctx->scanner.next(*value, ctx->symbols, ctx->diagnostics);
+}
+
+void yyerror(CompilerContext* ctx, const char* s) {
+    ctx->diagnostics.report("Parse error: %s at line %d\n", s, ctx->line());
+}
+
+// --- CompilerContext ---
+
+bool CompilerContext::parse(std::string_view source) {
+    root = nullptr;
+    if (scannerKind == ScannerKind::Flex) {
+        std::lock_guard<std::mutex> lock(flexMutex());
+        flexBeginSource(source);
+        bool ok = runParser();
+        flexEndSource();
+        return ok;
+    }
+    if (scannerKind == ScannerKind::Prelexed) {
+        if (!lexTokens(source, tokens, lexWorkers, scanner.simdLevel())) {
+            diagnostics.report("Input of %zu bytes is too large for the token buffer\n", source.size());
+            return false;
+        }
+        tokenSource = source.data();
+        nextToken = 0;
+        tokenLine = 1;
+        return runParser();
+    }
+    scanner.reset(source);
+    return runParser();
+}
+
+bool CompilerContext::parse(SourceFile& source) {
+    if (scannerKind != ScannerKind::Flex) return parse(source.text());
+
+    root = nullptr;
+    std::lock_guard<std::mutex> lock(flexMutex());
+    if (!flexBeginBuffer(source.data(), source.size())) {
+        diagnostics.report("Input of %zu bytes is too large for the flex scanner\n", source.size());
+        return false;
+    }
+    bool ok = runParser();
+    flexEndSource();
+    return ok;
+}
+
+bool CompilerContext::runParser() {
+    if (parserKind == ParserKind::Descent) return parseDescent(*this);
+    return yyparse(this) == 0;
+}
+
+int CompilerContext::nextBufferedToken(YYSTYPE& value) {
+    while (nextToken < tokens.size()) {
+        std::size_t i = nextToken++;
+        int token = tokens.kind[i];
+        tokenLine = static_cast<int>(tokens.line[i]);
+        std::string_view text(tokenSource + tokens.offset[i], tokens.length[i]);
+        if (acceptToken(token, text, tokenLine, value, symbols, diagnostics)) return token;
+    }
+    tokenLine = tokens.endLine;
+    return 0;
+}
+
+std::vector<Quad> CompilerContext::generate3AC() {
+    std::vector<Quad> quads;
+    ::generate3AC(root, tac, quads);
+    return quads;
+}
+
+int CompilerContext::line() const {
+    // Only called from inside parse(), where the flex lock is held.
+    if (scannerKind == ScannerKind::Flex) return flexLine();
+    return scannerKind == ScannerKind::Prelexed ? tokenLine : scanner.line();
+}
+
+void CompilerContext::reset() {
+    root = nullptr;
+    tokens.clear();
+    astArena.reset();
+    exprs.clear();
+    symbols.clear();
+    tac = TACState();
+    tac.diagnostics = &diagnostics;
+    diagnostics.clear();
+}
+
+// --- One-shot library entry point ---
+
+void compileParsed(CompilerContext& ctx, const CompileOptions& options, CompileResult& result) {
+    if (options.printAST) {
+        std::ostringstream text;
+        printAST(ctx.root, ctx.symbols, text, options.flatAST);
+        result.ast = text.str();
+    }
+
+    std::vector<Quad> quads = ctx.generate3AC();
+    if (options.optimize.any()) {
+        OptimizeStats stats;
+        std::string error;
+        optimizeQuads(quads, options.optimize, stats, error);  // Lowered quads always form a graph
+    }
+    if (options.print3AC) {
+        std::ostringstream text;
+        print3AC(quads, ctx.symbols, text);
+        result.tac = text.str();
+    }
+
+    AsmEmitter out(ctx.symbols);
+    out.setDiagnostics(&ctx.diagnostics);  // Returned in CompileResult::diagnostics
+    generate8086(quads, out);
+    result.assembly = std::string(out.contents());
+}
+
+CompileResult compile(std::string_view source, const CompileOptions& options) {
+    CompileResult result;
+    CompilerContext ctx;
+    ctx.scannerKind = options.scanner;
+    ctx.parserKind = options.parser;
+    ctx.exprs.setSharing(options.shareExpressions);
+
+    result.ok = ctx.parse(source) && ctx.root;
+    if (result.ok) compileParsed(ctx, options, result);
+    result.diagnostics = ctx.diagnostics.text();
+    return result;
+}
@@ -0,0 +1,110 @@
+#ifndef COMPILER_CONTEXT_H
+#define COMPILER_CONTEXT_H
+
+#include "arena.h"
+#include "ast.h"
+#include "diagnostics.h"
+#include "expr_factory.h"
+#include "optimizer.h"
+#include "scanner.h"
+#include "source_file.h"
+#include "symbol_table.h"
+#include "three_address_code.h"
+#include "token_buffer.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Which scanner feeds the parser.
+//   Builtin  - the reentrant hand-written Scanner (default)
+//   Flex     - the flex scanner from lexer.l; it keeps its state in globals, so
+//              compilations using it are serialized on a process-wide lock
+//   Prelexed - the builtin scanner run over the whole source before parsing starts
+//              (lexTokens, on `lexWorkers` threads); the parser then reads the
+//              TokenBuffer. Same tokens, messages and trace lines as Builtin.
+enum class ScannerKind { Builtin, Flex, Prelexed };
+
+// Which parser builds the AST. Both accept the same language, build the same tree and
+// report errors identically (see descent_parser.h).
+//   Bison   - the LALR parser generated from parser.y (default)
+//   Descent - the hand-written recursive-descent / Pratt parser
+enum class ParserKind { Bison, Descent };
+
+// Everything one compilation owns: identifiers, the AST arena, the scanner, the 3AC
+// numbering and its error messages. Contexts share nothing, so separate threads may each
+// drive their own context at the same time.
+struct CompilerContext {
+    SymbolTable symbols;
+    Arena astArena;
+    ExprFactory exprs{astArena};  // Expression nodes for the parsers (sharing is off by default)
+    Scanner scanner;
+    TACState tac;
+    Diagnostics diagnostics;
+    ASTNode* root = nullptr;
+    ScannerKind scannerKind = ScannerKind::Builtin;
+    ParserKind parserKind = ParserKind::Bison;
+
+    // Prelexed only: the tokens, the parser's position in them and the source they point into.
+    TokenBuffer tokens;
+    std::size_t nextToken = 0;
+    const char* tokenSource = nullptr;
+    int tokenLine = 1;
+    unsigned lexWorkers = 1;
+
+    CompilerContext() { tac.diagnostics = &diagnostics; }
+    CompilerContext(const CompilerContext&) = delete;
+    CompilerContext& operator=(const CompilerContext&) = delete;
+
+    // Parses `source` into `root`. Returns false on a syntax error. The text is only read
+    // while parsing; identifiers are copied into `symbols`. The builtin scanner reads the
+    // caller's buffer directly; flex works on a copy.
+    bool parse(std::string_view source);
+    // Same, but flex scans the file's memory in place too (it writes NUL terminators
+    // into the buffer while it runs and puts the original bytes back before returning).
+    bool parse(SourceFile& source);
+
+    // Runs the parser selected by parserKind; true if it accepted the input.
+    bool runParser();
+
+    // Hands the parser the next buffered token (Prelexed), completing it with acceptToken.
+    int nextBufferedToken(YYSTYPE& value);
+
+    // Lowers `root`, continuing this context's temp and label numbering.
+    std::vector<Quad> generate3AC();
+
+    // Line the scanner is on (used for parse error messages).
+    int line() const;
+
+    // Drops the AST, the identifiers, the counters and the messages, keeping the arena's
+    // first block, so the context can compile another source.
+    void reset();
+};
+
+// --- One-shot library entry point ---
+
+struct CompileOptions {
+    ScannerKind scanner = ScannerKind::Builtin;
+    ParserKind parser = ParserKind::Bison;
+    bool shareExpressions = false;  // Hash-cons pure expressions (see ExprFactory)
+    OptimizeOptions optimize;       // Passes run on the quads (see optimizer.h)
+    bool printAST = false;   // Fill CompileResult::ast
+    bool flatAST = false;    // ...showing each stmt_list as one node (see printAST)
+    bool print3AC = false;   // Fill CompileResult::tac
+};
+
+struct CompileResult {
+    bool ok = false;         // Parsed without syntax errors
+    std::string ast;         // Tree listing, if requested
+    std::string tac;         // 3AC listing, if requested (after optimization)
+    std::string assembly;    // 8086 program (same text the driver writes to output.asm)
+    std::string diagnostics; // Lexical, parse and semantic errors, then code generator warnings
+};
+
+// Compiles `source` in a private context. Safe to call from several threads at once.
+CompileResult compile(std::string_view source, const CompileOptions& options = CompileOptions());
+
+// The stages after parsing: lowers ctx.root and fills the listings and assembly of
+// `result` (not `ok` or `diagnostics`).
+void compileParsed(CompilerContext& ctx, const CompileOptions& options, CompileResult& result);
+
+#endif // COMPILER_CONTEXT_H
@@ -0,0 +1,353 @@
+#include "const_prop.h"
+#include "cfg.h"
+#include "verbosity.h"
+#include <algorithm>
+#include <deque>
+#include <utility>
+
+bool foldQuadOp(QuadOp op, std::int16_t a, std::int16_t b, std::int16_t& result) {
+    long x = a;
+    long y = b;
+    long value;
+    switch (op) {
+        case QuadOp::Add: value = x + y; break;
+        case QuadOp::Sub: value = x - y; break;
+        case QuadOp::Mul: value = x * y; break;
+        case QuadOp::Div:
+        case QuadOp::Mod:
+            if (y == 0 || (x == INT16_MIN && y == -1)) return false;
+            value = op == QuadOp::Div ? x / y : x % y;
+            break;
+        case QuadOp::Lt: value = x < y; break;
+        case QuadOp::Gt: value = x > y; break;
+        case QuadOp::Le: value = x <= y; break;
+        case QuadOp::Ge: value = x >= y; break;
+        case QuadOp::Eq: value = x == y; break;
+        case QuadOp::Ne: value = x != y; break;
+        default: return false;
+    }
+    result = wrap16(value);
+    return true;
+}
+
+namespace {
+
+// Lattice value: Top (not computed yet), a constant, or Bottom (not known before run time).
+struct Value {
+    enum Kind : std::uint8_t { Top, Const, Bottom } kind;
+    std::int16_t constant;
+};
+
+constexpr Value kTop{Value::Top, 0};
+constexpr Value kBottom{Value::Bottom, 0};
+Value constantValue(std::int16_t c) { return {Value::Const, c}; }
+
+bool definesResult(QuadOp op) {
+    return op != QuadOp::Label && op != QuadOp::Goto && op != QuadOp::If && op != QuadOp::IfFalse;
+}
+
+bool isBranch(QuadOp op) {
+    return op == QuadOp::If || op == QuadOp::IfFalse;
+}
+
+// Names known to be constant, sorted by key.
+using Constants = std::vector<std::pair<std::uint32_t, std::int16_t>>;
+
+// What is known at a block's entry. Until some taken edge leads to the block it has not
+// been reached; in a reached block every tracked name missing from `constants` is unknown.
+struct BlockState {
+    bool reached = false;
+    Constants constants;
+};
+
+// Values of the tracked names while one block is evaluated. A name not written since
+// load() has the value it had at the block's entry.
+class Environment {
+public:
+    void resize(std::size_t keys) {
+        stamps.assign(keys, 0);
+        values.assign(keys, kBottom);
+    }
+
+    void load(const Constants& entry) {
+        ++epoch;
+        touched.clear();
+        for (const auto& [key, constant] : entry) set(key, constantValue(constant));
+    }
+
+    Value get(std::uint32_t key) const { return stamps[key] == epoch ? values[key] : kBottom; }
+
+    void set(std::uint32_t key, Value value) {
+        if (stamps[key] != epoch) {
+            stamps[key] = epoch;
+            touched.push_back(key);
+        }
+        values[key] = value;
+    }
+
+    void store(Constants& exit) {
+        std::sort(touched.begin(), touched.end());
+        exit.clear();
+        for (std::uint32_t key : touched) {
+            if (values[key].kind == Value::Const) exit.push_back({key, values[key].constant});
+        }
+    }
+
+private:
+    std::vector<std::uint32_t> stamps;
+    std::vector<Value> values;
+    std::vector<std::uint32_t> touched;
+    std::uint32_t epoch = 0;
+};
+
+class ConstantPropagation {
+public:
+    ConstantPropagation(const std::vector<Quad>& quads, const ControlFlowGraph& cfg) : quads(quads), cfg(cfg) {}
+
+    void run();
+    void rewrite(std::vector<Quad>& out, ConstPropStats& stats);
+
+private:
+    void findLocalTemps();
+    void visit(std::uint32_t block);
+    bool takesEdge(std::uint32_t block, std::uint32_t successor) const;
+
+    Value valueOf(const Operand& operand) const;
+    void define(const Operand& result, Value value);
+    Value evaluate(const Quad& q) const;
+    bool isLocal(const Operand& operand) const {
+        return operand.kind == OperandKind::Temp && localTemps[operand.value];
+    }
+
+    const std::vector<Quad>& quads;
+    const ControlFlowGraph& cfg;
+
+    // Variables are keyed by symbol, and temps follow them (temp t is varCount + t).
+    // Local temps (defined once, and only used after that in the same block) are not
+    // tracked per block: their value is simply the one computed by the last evaluation.
+    std::size_t varCount = 0;
+    std::vector<bool> localTemps;
+    std::vector<Value> localValues;
+
+    std::vector<BlockState> states;
+    Environment env;
+    Constants exit;  // Scratch: what visit() hands to the successors
+};
+
+// Keys, and which temps are local.
+void ConstantPropagation::findLocalTemps() {
+    int maxVar = -1;
+    int maxTemp = -1;
+    auto note = [&](const Operand& operand) {
+        if (operand.kind == OperandKind::Var) maxVar = std::max(maxVar, operand.value);
+        else if (operand.kind == OperandKind::Temp) maxTemp = std::max(maxTemp, operand.value);
+    };
+    for (const Quad& q : quads) {
+        note(q.arg1);
+        note(q.arg2);
+        note(q.result);
+    }
+    varCount = static_cast<std::size_t>(maxVar + 1);
+    std::size_t tempCount = static_cast<std::size_t>(maxTemp + 1);
+    env.resize(varCount + tempCount);
+    localValues.assign(tempCount, kTop);
+
+    std::vector<std::uint32_t> definitions(tempCount, 0);  // Definition count per temp
+    std::vector<std::uint32_t> definedAt(tempCount, 0);    // Quad of the (last) definition
+    for (std::size_t i = 0; i < quads.size(); ++i) {
+        const Operand& result = quads[i].result;
+        if (definesResult(quads[i].op) && result.kind == OperandKind::Temp) {
+            ++definitions[result.value];
+            definedAt[result.value] = static_cast<std::uint32_t>(i);
+        }
+    }
+    localTemps.assign(tempCount, false);
+    for (std::size_t t = 0; t < tempCount; ++t) localTemps[t] = definitions[t] == 1;
+    for (const BasicBlock& block : cfg.blocks) {
+        for (std::uint32_t i = block.first; i < block.last; ++i) {
+            const Quad& q = quads[i];
+            for (const Operand* use : {&q.arg1, &q.arg2}) {
+                if (use->kind != OperandKind::Temp || !localTemps[use->value]) continue;
+                std::uint32_t at = definedAt[use->value];
+                if (at >= i || at < block.first) localTemps[use->value] = false;
+            }
+            // A temp in the result slot of a jump or label is not a definition.
+            if (!definesResult(q.op) && q.result.kind == OperandKind::Temp) localTemps[q.result.value] = false;
+        }
+    }
+}
+
+Value ConstantPropagation::valueOf(const Operand& operand) const {
+    switch (operand.kind) {
+        case OperandKind::Imm:  return constantValue(wrap16(operand.value));
+        case OperandKind::Var:  return env.get(static_cast<std::uint32_t>(operand.value));
+        case OperandKind::Temp:
+            if (localTemps[operand.value]) return localValues[operand.value];
+            return env.get(static_cast<std::uint32_t>(varCount + operand.value));
+        default:                return kBottom;
+    }
+}
+
+void ConstantPropagation::define(const Operand& result, Value value) {
+    // Block states only tell constants from unknowns, so a Top stored in a tracked name
+    // is recorded as unknown. Only local temps can be Top, and they are defined before
+    // use, so this never loses a constant for quads from the lowering pass.
+    if (result.kind == OperandKind::Var) {
+        env.set(static_cast<std::uint32_t>(result.value), value.kind == Value::Top ? kBottom : value);
+    } else if (result.kind == OperandKind::Temp) {
+        if (localTemps[result.value]) localValues[result.value] = value;
+        else env.set(static_cast<std::uint32_t>(varCount + result.value), value.kind == Value::Top ? kBottom : value);
+    }
+}
+
+// Value of the result of a quad that defines one, from the values of its operands.
+Value ConstantPropagation::evaluate(const Quad& q) const {
+    if (q.op == QuadOp::Assign) return valueOf(q.arg1);
+    Value a = valueOf(q.arg1);
+    Value b = valueOf(q.arg2);
+    if (a.kind == Value::Top || b.kind == Value::Top) return kTop;
+    std::int16_t result;
+    if (a.kind == Value::Const && b.kind == Value::Const && foldQuadOp(q.op, a.constant, b.constant, result))
+        return constantValue(result);
+    return kBottom;
+}
+
+// With the block's values still loaded: whether control can take the edge to `successor`.
+bool ConstantPropagation::takesEdge(std::uint32_t block, std::uint32_t successor) const {
+    const Quad& last = quads[cfg.blocks[block].last - 1];
+    if (!isBranch(last.op)) return true;
+    Value condition = valueOf(last.arg1);
+    if (condition.kind == Value::Top) return false;
+    if (condition.kind == Value::Bottom) return true;
+    bool jumps = (last.op == QuadOp::IfFalse) == (condition.constant == 0);
+    return successor == (jumps ? cfg.blockOf(last.result) : block + 1);
+}
+
+void ConstantPropagation::visit(std::uint32_t b) {
+    const BasicBlock& block = cfg.blocks[b];
+    env.load(states[b].constants);
+    for (std::uint32_t i = block.first; i < block.last; ++i) {
+        if (definesResult(quads[i].op)) define(quads[i].result, evaluate(quads[i]));
+    }
+    env.store(exit);
+}
+
+void ConstantPropagation::run() {
+    findLocalTemps();
+    states.assign(cfg.blocks.size(), BlockState());
+    if (cfg.blocks.empty()) return;
+
+    // A block is (re)visited when its entry state changes: when it is first reached, and
+    // each time a predecessor's exit state drops a constant. States only ever lose
+    // constants, so this ends.
+    std::vector<bool> queued(cfg.blocks.size(), false);
+    std::deque<std::uint32_t> worklist;
+    states[0].reached = true;
+    worklist.push_back(0);
+    queued[0] = true;
+    while (!worklist.empty()) {
+        std::uint32_t b = worklist.front();
+        worklist.pop_front();
+        queued[b] = false;
+        visit(b);
+        for (std::uint32_t s : cfg.successors(b)) {
+            if (!takesEdge(b, s)) continue;
+            BlockState& state = states[s];
+            bool changed;
+            if (!state.reached) {
+                state.reached = true;
+                state.constants = exit;
+                changed = true;
+            } else {
+                // Keep the constants both sides agree on.
+                std::size_t kept = 0;
+                std::size_t j = 0;
+                for (const auto& entry : state.constants) {
+                    while (j < exit.size() && exit[j].first < entry.first) ++j;
+                    if (j < exit.size() && exit[j] == entry) state.constants[kept++] = entry;
+                }
+                changed = kept != state.constants.size();
+                state.constants.resize(kept);
+            }
+            if (changed && !queued[s]) {
+                queued[s] = true;
+                worklist.push_back(s);
+            }
+        }
+    }
+}
+
+void ConstantPropagation::rewrite(std::vector<Quad>& out, ConstPropStats& stats) {
+    out.clear();
+    out.reserve(quads.size());
+    for (std::uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+        const BasicBlock& block = cfg.blocks[b];
+        if (!states[b].reached) {
+            ++stats.blocksRemoved;
+            continue;
+        }
+        env.load(states[b].constants);
+        for (std::uint32_t i = block.first; i < block.last; ++i) {
+            Quad q = quads[i];
+            if (isBranch(q.op)) {
+                Value condition = valueOf(q.arg1);
+                if (condition.kind == Value::Const) {
+                    ++stats.branchesResolved;
+                    if ((q.op == QuadOp::IfFalse) == (condition.constant == 0))
+                        out.push_back({QuadOp::Goto, noOperand(), noOperand(), q.result});
+                    continue;
+                }
+            } else if (definesResult(q.op)) {
+                Value value = evaluate(q);
+                if (value.kind == Value::Const) {
+                    bool literal = q.op == QuadOp::Assign && q.arg1.kind == OperandKind::Imm;
+                    if (!literal) {
+                        ++stats.folded;
+                        q = {QuadOp::Assign, immOperand(value.constant), noOperand(), q.result};
+                    }
+                    define(q.result, value);
+                    if (isLocal(q.result)) continue;  // Every use becomes the literal
+                } else {
+                    for (Operand* use : {&q.arg1, &q.arg2}) {
+                        Value known = valueOf(*use);
+                        if (use->kind != OperandKind::Imm && known.kind == Value::Const) *use = immOperand(known.constant);
+                    }
+                    define(q.result, value);
+                }
+            }
+            out.push_back(q);
+        }
+    }
+
+    // A resolved branch can leave "goto L" right before "L:".
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        if (out[i].op == QuadOp::Goto) {
+            bool toNext = false;
+            for (std::size_t j = i + 1; j < out.size() && out[j].op == QuadOp::Label && !toNext; ++j)
+                toNext = out[j].result.value == out[i].result.value;
+            if (toNext) continue;
+        }
+        out[kept++] = out[i];
+    }
+    out.resize(kept);
+}
+
+} // end anonymous namespace
+
+bool propagateConstants(std::vector<Quad>& quads, ConstPropStats& stats, std::string& error) {
+    stats = ConstPropStats();
+    stats.quadsBefore = quads.size();
+    ControlFlowGraph cfg;
+    if (!buildCFG(quads, cfg, error)) return false;
+
+    ConstantPropagation pass(quads, cfg);
+    pass.run();
+    std::vector<Quad> rewritten;
+    pass.rewrite(rewritten, stats);
+    quads.swap(rewritten);
+    stats.quadsAfter = quads.size();
+    LOG_DEBUG("DEBUG: propagateConstants - %zu -> %zu quads, %zu folded, %zu branches resolved, %zu blocks removed.\n",
+              stats.quadsBefore, stats.quadsAfter, stats.folded, stats.branchesResolved, stats.blocksRemoved);
+    return true;
+}
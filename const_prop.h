@@ -0,0 +1,50 @@
+#ifndef CONST_PROP_H
+#define CONST_PROP_H
+
+#include "three_address_code.h" // For Quad
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// --- Constant folding and propagation ---
+// Sparse conditional constant propagation over the control-flow graph (cfg.h), in the
+// style of Wegman and Zadeck: blocks are only visited once an edge into them is known to
+// be taken, and a branch on a known condition only takes one edge. Every variable and
+// temp is tracked per block entry as "a known constant" or "unknown".
+//
+// Arithmetic follows the 8086: values are 16-bit, +, - and * wrap around, / and % truncate
+// toward zero, and comparisons are signed. A division by zero, or -32768 / -1 (which
+// faults on the 8086), is left for run time.
+//
+// The quads are then rewritten:
+//   - operands with a known value become literals, and quads whose result is known
+//     become "result = value"; a temp used only after its definition in the same
+//     block is dropped once it is known, as every use has become the literal
+//   - if / ifFalse on a known condition becomes a goto or disappears
+//   - blocks that are never reached are deleted, and so is a goto to the label
+//     right after it
+// Assignments to variables stay (removing dead stores is another pass).
+
+struct ConstPropStats {
+    std::size_t quadsBefore = 0;
+    std::size_t quadsAfter = 0;
+    std::size_t folded = 0;            // Quads whose result became a known constant
+    std::size_t branchesResolved = 0;  // if / ifFalse with a known condition
+    std::size_t blocksRemoved = 0;     // Blocks no execution reaches
+};
+
+// Wraps to the 8086's 16-bit signed range.
+inline std::int16_t wrap16(long value) {
+    return static_cast<std::int16_t>(static_cast<std::uint16_t>(value));
+}
+
+// Folds `a op b` for an arithmetic or relational op. Returns false if the result is
+// left for run time (division by zero and -32768 / -1).
+bool foldQuadOp(QuadOp op, std::int16_t a, std::int16_t b, std::int16_t& result);
+
+// Rewrites `quads` in place. Fails only if they do not form a control-flow graph (see
+// buildCFG), setting `error` and leaving them untouched.
+bool propagateConstants(std::vector<Quad>& quads, ConstPropStats& stats, std::string& error);
+
+#endif // CONST_PROP_H
@@ -0,0 +1,217 @@
+#include "copy_prop.h"
+#include "verbosity.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+constexpr std::uint32_t kNoName = UINT32_MAX;
+
+bool isJump(QuadOp op) {
+    return op == QuadOp::Goto || op == QuadOp::If || op == QuadOp::IfFalse;
+}
+
+bool isArithmetic(QuadOp op) {
+    return op == QuadOp::Add || op == QuadOp::Sub || op == QuadOp::Mul || op == QuadOp::Div || op == QuadOp::Mod;
+}
+
+bool definesResult(QuadOp op) {
+    return op != QuadOp::Label && !isJump(op);
+}
+
+bool startsBlock(const std::vector<Quad>& quads, std::size_t i) {
+    return i == 0 || quads[i].op == QuadOp::Label || isJump(quads[i - 1].op);
+}
+
+bool sameOperand(const Operand& a, const Operand& b) {
+    return a.kind == b.kind && a.value == b.value;
+}
+
+std::size_t countTemps(const std::vector<Quad>& quads, const std::vector<bool>& removed, std::size_t tempCount) {
+    std::vector<bool> seen(tempCount, false);
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < quads.size(); ++i) {
+        if (removed[i]) continue;
+        for (const Operand* operand : {&quads[i].arg1, &quads[i].arg2, &quads[i].result}) {
+            if (operand->kind == OperandKind::Temp && !seen[operand->value]) {
+                seen[operand->value] = true;
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+class CopyPropagation {
+public:
+    CopyPropagation(std::vector<Quad>& quads, CopyPropStats& stats);
+
+    void propagate();
+    void dropUnreadTemps();
+    void coalesce();
+    // Drops the quads marked as removed.
+    void compact();
+
+    std::size_t tempCount() const { return uses.size(); }
+    const std::vector<bool>& removedQuads() const { return removed; }
+
+private:
+    // Variables are named by symbol and temps follow them.
+    std::uint32_t nameOf(const Operand& operand) const {
+        if (operand.kind == OperandKind::Var) return static_cast<std::uint32_t>(operand.value);
+        if (operand.kind == OperandKind::Temp) return static_cast<std::uint32_t>(varCount + operand.value);
+        return kNoName;
+    }
+    void addUse(const Operand& operand, int delta) {
+        if (operand.kind == OperandKind::Temp) uses[operand.value] += delta;
+    }
+
+    std::vector<Quad>& quads;
+    CopyPropStats& stats;
+    std::size_t varCount = 0;
+    std::size_t nameCount = 0;
+    std::vector<std::uint32_t> uses;     // Per temp: operands reading it
+    std::vector<std::uint32_t> defs;     // Per temp: quads setting it
+    std::vector<std::size_t> defAt;      // Per temp: the quad setting it, if just one
+    std::vector<bool> removed;
+};
+
+CopyPropagation::CopyPropagation(std::vector<Quad>& quads, CopyPropStats& stats)
+    : quads(quads), stats(stats), removed(quads.size(), false) {
+    int maxVar = -1;
+    int maxTemp = -1;
+    for (const Quad& q : quads) {
+        for (const Operand* operand : {&q.arg1, &q.arg2, &q.result}) {
+            if (operand->kind == OperandKind::Var) maxVar = std::max(maxVar, operand->value);
+            else if (operand->kind == OperandKind::Temp) maxTemp = std::max(maxTemp, operand->value);
+        }
+    }
+    varCount = static_cast<std::size_t>(maxVar + 1);
+    nameCount = varCount + static_cast<std::size_t>(maxTemp + 1);
+    uses.assign(static_cast<std::size_t>(maxTemp + 1), 0);
+    defs.assign(uses.size(), 0);
+    defAt.assign(uses.size(), 0);
+    for (std::size_t i = 0; i < quads.size(); ++i) {
+        const Quad& q = quads[i];
+        addUse(q.arg1, 1);
+        addUse(q.arg2, 1);
+        if (definesResult(q.op) && q.result.kind == OperandKind::Temp) {
+            ++defs[q.result.value];
+            defAt[q.result.value] = i;
+        }
+    }
+}
+
+void CopyPropagation::propagate() {
+    // A temp's copy holds while it was made in the current block and neither the temp
+    // nor the source has been set since; every definition bumps the name's version.
+    std::vector<Operand> source(nameCount, noOperand());
+    std::vector<std::uint32_t> copyBlock(nameCount, 0);  // 0: no copy
+    std::vector<std::uint32_t> sourceVersion(nameCount, 0);
+    std::vector<std::uint32_t> version(nameCount, 0);
+    std::uint32_t block = 0;
+
+    auto copyOf = [&](const Operand& operand) -> const Operand* {
+        if (operand.kind != OperandKind::Temp) return nullptr;
+        std::uint32_t name = nameOf(operand);
+        if (copyBlock[name] != block) return nullptr;
+        const Operand& from = source[name];
+        if (from.kind != OperandKind::Imm && version[nameOf(from)] != sourceVersion[name]) return nullptr;
+        return &from;
+    };
+
+    for (std::size_t i = 0; i < quads.size(); ++i) {
+        if (startsBlock(quads, i)) ++block;
+        Quad& q = quads[i];
+        if (!definesResult(q.op)) continue;  // Branch conditions stay as they are
+        for (Operand* use : {&q.arg1, &q.arg2}) {
+            const Operand* from = copyOf(*use);
+            if (!from) continue;
+            addUse(*use, -1);
+            *use = *from;
+            addUse(*use, 1);
+            ++stats.propagated;
+        }
+        std::uint32_t name = nameOf(q.result);
+        ++version[name];
+        copyBlock[name] = 0;
+        if (q.op == QuadOp::Assign && q.result.kind == OperandKind::Temp && !sameOperand(q.arg1, q.result)) {
+            source[name] = q.arg1;
+            copyBlock[name] = block;
+            if (q.arg1.kind != OperandKind::Imm) sourceVersion[name] = version[nameOf(q.arg1)];
+        }
+    }
+}
+
+void CopyPropagation::dropUnreadTemps() {
+    // Backward, so a quad feeding only dropped quads goes in the same sweep.
+    for (std::size_t i = quads.size(); i-- > 0;) {
+        const Quad& q = quads[i];
+        if (!definesResult(q.op) || q.result.kind != OperandKind::Temp || uses[q.result.value] != 0) continue;
+        removed[i] = true;
+        --defs[q.result.value];
+        addUse(q.arg1, -1);
+        addUse(q.arg2, -1);
+        ++stats.deadTemps;
+    }
+}
+
+void CopyPropagation::coalesce() {
+    // Index + 1 of the last kept quad naming each variable or temp (0: none), so an
+    // interval with no mention of a name is a comparison away.
+    std::vector<std::size_t> lastMention(nameCount, 0);
+    std::size_t blockFirst = 0;
+    for (std::size_t j = 0; j < quads.size(); ++j) {
+        if (startsBlock(quads, j)) blockFirst = j;
+        if (removed[j]) continue;
+        Quad& copy = quads[j];
+        if (copy.op == QuadOp::Assign && copy.arg1.kind == OperandKind::Temp && !sameOperand(copy.arg1, copy.result)) {
+            std::int32_t temp = copy.arg1.value;
+            std::size_t i = defAt[temp];
+            std::uint32_t target = nameOf(copy.result);
+            if (uses[temp] == 1 && defs[temp] == 1 && i >= blockFirst && i < j && !removed[i] &&
+                (quads[i].op == QuadOp::Assign || isArithmetic(quads[i].op)) && lastMention[target] <= i + 1) {
+                Quad& def = quads[i];
+                def.result = copy.result;
+                removed[j] = true;
+                ++stats.coalesced;
+                // `t1 = x; x = t1` leaves `x = x`.
+                if (def.op == QuadOp::Assign && sameOperand(def.arg1, def.result)) removed[i] = true;
+                lastMention[target] = i + 1;
+                continue;
+            }
+        }
+        for (const Operand* operand : {&copy.arg1, &copy.arg2, &copy.result}) {
+            std::uint32_t name = nameOf(*operand);
+            if (name != kNoName) lastMention[name] = j + 1;
+        }
+    }
+}
+
+void CopyPropagation::compact() {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < quads.size(); ++i) {
+        if (!removed[i]) quads[kept++] = quads[i];
+    }
+    quads.resize(kept);
+}
+
+} // end anonymous namespace
+
+void propagateCopies(std::vector<Quad>& quads, CopyPropStats& stats) {
+    stats = CopyPropStats();
+    stats.quadsBefore = quads.size();
+
+    CopyPropagation pass(quads, stats);
+    std::size_t tempsBefore = countTemps(quads, pass.removedQuads(), pass.tempCount());
+    pass.propagate();
+    pass.dropUnreadTemps();
+    pass.coalesce();
+    std::size_t tempsAfter = countTemps(quads, pass.removedQuads(), pass.tempCount());
+    pass.compact();
+
+    stats.quadsAfter = quads.size();
+    stats.tempsRemoved = tempsBefore - tempsAfter;
+    LOG_DEBUG("DEBUG: propagateCopies - %zu -> %zu quads (%zu operands propagated, %zu temps coalesced, %zu dead), %zu temps removed.\n",
+              stats.quadsBefore, stats.quadsAfter, stats.propagated, stats.coalesced, stats.deadTemps, stats.tempsRemoved);
+}
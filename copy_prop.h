@@ -0,0 +1,35 @@
+#ifndef COPY_PROP_H
+#define COPY_PROP_H
+
+#include "three_address_code.h" // For Quad
+#include <cstddef>
+#include <vector>
+
+// --- Copy propagation and temp coalescing ---
+// generate3AC computes every value into a fresh temp and copies it where it belongs
+// (`t1 = a + b; x = t1`, and `t2 = i + 1; i = t2` for i++), and value numbering leaves
+// copies between temps behind. Each temp costs generate8086 a DW and each copy a pair of
+// MOVs, so this pass removes them, in three steps over the quads:
+//   - propagation: a use of a temp set by a copy (`t2 = t1`, `t2 = x`, `t2 = 5`) reads
+//     the source instead, while neither has been set again
+//   - temps no quad reads any more are dropped, along with the quads that set them
+//   - coalescing: a temp set once and read once, by a copy in the same block, is
+//     replaced by the copy's target: `t1 = a + b; x = t1` becomes `x = a + b`, provided
+//     nothing between the two quads reads or sets x
+// All three work within basic blocks (a label or a jump ends one), so no graph is
+// needed. Comparisons are never moved and branch conditions never rewritten, since
+// generate8086 builds each ifFalse from the quad that set its condition temp.
+
+struct CopyPropStats {
+    std::size_t quadsBefore = 0;
+    std::size_t quadsAfter = 0;
+    std::size_t propagated = 0;    // Operands that now read a copy's source
+    std::size_t coalesced = 0;     // Temps whose copy now receives the value directly
+    std::size_t deadTemps = 0;     // Quads setting a temp nothing reads
+    std::size_t tempsRemoved = 0;  // Temps that no longer need a DW
+};
+
+// Rewrites `quads` in place.
+void propagateCopies(std::vector<Quad>& quads, CopyPropStats& stats);
+
+#endif // COPY_PROP_H
@@ -0,0 +1,295 @@
+#include "dead_code.h"
+#include "cfg.h"
+#include "verbosity.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+constexpr std::uint32_t kNoKey = UINT32_MAX;
+
+// The per-block live sets are given up (every name that crosses blocks then counts as
+// live everywhere, so only dead code within a block goes) past this many 64-bit words.
+constexpr std::size_t kMaxLivenessWords = std::size_t(1) << 24;
+
+bool definesResult(QuadOp op) {
+    return op != QuadOp::Label && op != QuadOp::Goto && op != QuadOp::If && op != QuadOp::IfFalse;
+}
+
+// Distinct variables and temps the quads mention, i.e. the DW lines generate8086 emits.
+std::size_t countDataWords(const std::vector<Quad>& quads) {
+    std::vector<bool> vars;
+    std::vector<bool> temps;
+    std::size_t count = 0;
+    auto mark = [&](const Operand& operand) {
+        std::vector<bool>* seen = operand.kind == OperandKind::Var ? &vars : operand.kind == OperandKind::Temp ? &temps : nullptr;
+        if (!seen) return;
+        if (static_cast<std::size_t>(operand.value) >= seen->size()) seen->resize(operand.value + 1, false);
+        if (!(*seen)[operand.value]) {
+            (*seen)[operand.value] = true;
+            ++count;
+        }
+    };
+    for (const Quad& q : quads) {
+        mark(q.arg1);
+        mark(q.arg2);
+        mark(q.result);
+    }
+    return count;
+}
+
+class Liveness {
+public:
+    Liveness(const std::vector<Quad>& quads, const ControlFlowGraph& cfg) : quads(quads), cfg(cfg) {}
+
+    // Computes what is live at each block's entry.
+    void run();
+    // Appends the quads worth keeping to `out`, in order.
+    void sweep(std::vector<Quad>& out, DeadCodeStats& stats);
+
+private:
+    void assignKeys();
+    std::uint32_t keyOf(const Operand& operand) const {
+        if (operand.kind == OperandKind::Var) return static_cast<std::uint32_t>(operand.value);
+        if (operand.kind == OperandKind::Temp) return tempKeys[operand.value];
+        return kNoKey;
+    }
+    void liveOut(std::uint32_t block, std::uint64_t* live) const;
+    void transfer(std::uint32_t block, std::uint64_t* live) const;
+
+    static bool test(const std::uint64_t* set, std::uint32_t key) { return (set[key >> 6] >> (key & 63)) & 1; }
+    static void add(std::uint64_t* set, std::uint32_t key) { set[key >> 6] |= std::uint64_t(1) << (key & 63); }
+    static void remove(std::uint64_t* set, std::uint32_t key) { set[key >> 6] &= ~(std::uint64_t(1) << (key & 63)); }
+
+    const std::vector<Quad>& quads;
+    const ControlFlowGraph& cfg;
+
+    // Variables are keyed by symbol and the temps that cross blocks follow them. A temp
+    // whose every use comes after a definition in the same block is local (kNoKey): it is
+    // dead at the end of that block, so it is tracked while sweeping the block only.
+    std::size_t varCount = 0;
+    std::vector<std::uint32_t> tempKeys;
+    std::size_t words = 0;      // Per set
+    bool exact = false;         // False if the per-block sets were given up
+    std::vector<std::uint64_t> liveIn;    // One set per block
+    std::vector<std::uint64_t> exitLive;  // Live after the last quad: every variable
+};
+
+void Liveness::assignKeys() {
+    int maxVar = -1;
+    int maxTemp = -1;
+    for (const Quad& q : quads) {
+        for (const Operand* operand : {&q.arg1, &q.arg2, &q.result}) {
+            if (operand->kind == OperandKind::Var) maxVar = std::max(maxVar, operand->value);
+            else if (operand->kind == OperandKind::Temp) maxTemp = std::max(maxTemp, operand->value);
+        }
+    }
+    varCount = static_cast<std::size_t>(maxVar + 1);
+
+    // Block of each temp's first appearance, or kNoBlock once it shows up in a second
+    // block or is read before it is set.
+    std::vector<std::uint32_t> homes(static_cast<std::size_t>(maxTemp + 1), kNoBlock);
+    std::vector<bool> crossing(homes.size(), false);
+    auto note = [&](const Operand& operand, std::uint32_t block, bool isUse) {
+        if (operand.kind != OperandKind::Temp) return;
+        std::uint32_t& home = homes[operand.value];
+        if (home == kNoBlock && !crossing[operand.value]) {
+            home = block;
+            if (isUse) crossing[operand.value] = true;
+        } else if (home != block) {
+            crossing[operand.value] = true;
+        }
+    };
+    for (std::uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+        for (std::uint32_t i = cfg.blocks[b].first; i < cfg.blocks[b].last; ++i) {
+            const Quad& q = quads[i];
+            note(q.arg1, b, true);
+            note(q.arg2, b, true);
+            note(q.result, b, !definesResult(q.op));
+        }
+    }
+    std::uint32_t next = static_cast<std::uint32_t>(varCount);
+    tempKeys.assign(homes.size(), kNoKey);
+    for (std::size_t t = 0; t < homes.size(); ++t) {
+        if (crossing[t]) tempKeys[t] = next++;
+    }
+    words = (static_cast<std::size_t>(next) + 63) / 64;
+}
+
+void Liveness::liveOut(std::uint32_t block, std::uint64_t* live) const {
+    if (cfg.blocks[block].successorCount == 0) {
+        std::copy(exitLive.begin(), exitLive.end(), live);
+        return;
+    }
+    std::fill(live, live + words, 0);
+    for (std::uint32_t s : cfg.successors(block)) {
+        const std::uint64_t* in = &liveIn[s * words];
+        for (std::size_t w = 0; w < words; ++w) live[w] |= in[w];
+    }
+}
+
+// Turns the set live at the end of `block` into the set live at its start.
+void Liveness::transfer(std::uint32_t block, std::uint64_t* live) const {
+    for (std::uint32_t i = cfg.blocks[block].last; i-- > cfg.blocks[block].first;) {
+        const Quad& q = quads[i];
+        if (definesResult(q.op)) {
+            std::uint32_t key = keyOf(q.result);
+            if (key != kNoKey) remove(live, key);
+        }
+        for (const Operand* use : {&q.arg1, &q.arg2}) {
+            std::uint32_t key = keyOf(*use);
+            if (key != kNoKey) add(live, key);
+        }
+    }
+}
+
+void Liveness::run() {
+    assignKeys();
+    exitLive.assign(words, 0);
+    for (std::uint32_t v = 0; v < varCount; ++v) add(exitLive.data(), v);
+    exact = words == 0 || cfg.blocks.size() <= kMaxLivenessWords / words;
+    if (!exact) {
+        LOG_DEBUG("DEBUG: eliminateDeadCode - %zu blocks x %zu words of liveness is too much; keeping every name that crosses blocks.\n",
+                  cfg.blocks.size(), words);
+        return;
+    }
+    liveIn.assign(cfg.blocks.size() * words, 0);
+
+    // Backward problem: visit blocks in postorder, and revisit a block's predecessors
+    // whenever its entry set grows.
+    std::vector<bool> queued(cfg.blocks.size(), false);
+    std::vector<std::uint32_t> worklist(cfg.reversePostorder.begin(), cfg.reversePostorder.end());
+    for (std::uint32_t b : worklist) queued[b] = true;
+    std::vector<std::uint64_t> live(words);
+    while (!worklist.empty()) {
+        std::uint32_t b = worklist.back();
+        worklist.pop_back();
+        queued[b] = false;
+        liveOut(b, live.data());
+        transfer(b, live.data());
+        std::uint64_t* in = &liveIn[b * words];
+        if (std::equal(live.begin(), live.end(), in)) continue;
+        std::copy(live.begin(), live.end(), in);
+        for (std::uint32_t p : cfg.predecessors(b)) {
+            if (!queued[p]) {
+                queued[p] = true;
+                worklist.push_back(p);
+            }
+        }
+    }
+}
+
+void Liveness::sweep(std::vector<Quad>& out, DeadCodeStats& stats) {
+    std::vector<bool> reachable(cfg.blocks.size(), false);
+    for (std::uint32_t b : cfg.reversePostorder) reachable[b] = true;
+    std::vector<std::uint64_t> live(words);
+    std::vector<bool> localLive(tempKeys.size(), false);  // All false between blocks
+    std::vector<bool> keep;
+
+    auto isLive = [&](const Operand& operand) {
+        if (operand.kind == OperandKind::Temp && tempKeys[operand.value] == kNoKey) return bool(localLive[operand.value]);
+        std::uint32_t key = keyOf(operand);
+        return key == kNoKey || !exact || test(live.data(), key);
+    };
+    auto setLive = [&](const Operand& operand, bool value) {
+        if (operand.kind == OperandKind::Temp && tempKeys[operand.value] == kNoKey) {
+            localLive[operand.value] = value;
+            return;
+        }
+        std::uint32_t key = keyOf(operand);
+        if (key == kNoKey || !exact) return;
+        if (value) add(live.data(), key);
+        else remove(live.data(), key);
+    };
+
+    for (std::uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+        const BasicBlock& block = cfg.blocks[b];
+        if (!reachable[b]) {
+            stats.unreachableQuads += block.last - block.first;
+            continue;
+        }
+        if (exact) liveOut(b, live.data());
+        keep.assign(block.last - block.first, true);
+        for (std::uint32_t i = block.last; i-- > block.first;) {
+            const Quad& q = quads[i];
+            if (definesResult(q.op)) {
+                if (!isLive(q.result)) {
+                    keep[i - block.first] = false;
+                    ++stats.deadDefinitions;
+                    continue;
+                }
+                setLive(q.result, false);
+            }
+            for (const Operand* use : {&q.arg1, &q.arg2}) setLive(*use, true);
+        }
+        for (std::uint32_t i = block.first; i < block.last; ++i) {
+            if (keep[i - block.first]) out.push_back(quads[i]);
+        }
+    }
+}
+
+// Drops a goto to the label right after it (or after a run of labels), then the labels
+// no jump names.
+void removeJumpsAndLabels(std::vector<Quad>& quads, DeadCodeStats& stats) {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < quads.size(); ++i) {
+        if (quads[i].op == QuadOp::Goto) {
+            bool toNext = false;
+            for (std::size_t j = i + 1; j < quads.size() && quads[j].op == QuadOp::Label && !toNext; ++j)
+                toNext = quads[j].result.value == quads[i].result.value;
+            if (toNext) {
+                ++stats.jumpsAndLabels;
+                continue;
+            }
+        }
+        quads[kept++] = quads[i];
+    }
+    quads.resize(kept);
+
+    std::vector<bool> targeted;
+    for (const Quad& q : quads) {
+        if (q.op != QuadOp::Goto && q.op != QuadOp::If && q.op != QuadOp::IfFalse) continue;
+        if (static_cast<std::size_t>(q.result.value) >= targeted.size()) targeted.resize(q.result.value + 1, false);
+        targeted[q.result.value] = true;
+    }
+    kept = 0;
+    for (const Quad& q : quads) {
+        if (q.op == QuadOp::Label && (static_cast<std::size_t>(q.result.value) >= targeted.size() || !targeted[q.result.value])) {
+            ++stats.jumpsAndLabels;
+            continue;
+        }
+        quads[kept++] = q;
+    }
+    quads.resize(kept);
+}
+
+} // end anonymous namespace
+
+bool eliminateDeadCode(std::vector<Quad>& quads, DeadCodeStats& stats, std::string& error) {
+    stats = DeadCodeStats();
+    stats.quadsBefore = quads.size();
+    std::size_t wordsBefore = countDataWords(quads);
+
+    ControlFlowGraph cfg;
+    std::vector<Quad> kept;
+    for (;;) {
+        // Only the caller's quads can fail: every round keeps the labels its jumps need.
+        if (!buildCFG(quads, cfg, error)) return false;
+        ++stats.rounds;
+        Liveness liveness(quads, cfg);
+        liveness.run();
+        kept.clear();
+        liveness.sweep(kept, stats);
+        removeJumpsAndLabels(kept, stats);
+        bool changed = kept.size() != quads.size();
+        quads.swap(kept);
+        if (!changed) break;
+    }
+
+    stats.quadsAfter = quads.size();
+    stats.dataWordsRemoved = wordsBefore - countDataWords(quads);
+    LOG_DEBUG("DEBUG: eliminateDeadCode - %zu -> %zu quads in %zu rounds (%zu dead, %zu unreachable, %zu jumps and labels), %zu data words removed.\n",
+              stats.quadsBefore, stats.quadsAfter, stats.rounds, stats.deadDefinitions, stats.unreachableQuads,
+              stats.jumpsAndLabels, stats.dataWordsRemoved);
+    return true;
+}
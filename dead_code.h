@@ -0,0 +1,35 @@
+#ifndef DEAD_CODE_H
+#define DEAD_CODE_H
+
+#include "three_address_code.h" // For Quad
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// --- Dead code elimination ---
+// Removes what cannot affect the program's result:
+//   - blocks the entry cannot reach (e.g. the code after the goto of a `break`)
+//   - quads whose result is never read: temps nobody uses, and stores to a variable
+//     that every path overwrites before reading it. Variables count as read at the end
+//     of the program, since they are its result; temps do not.
+//   - a goto to the label right after it, and labels nobody jumps to
+// Liveness is computed per block over the control-flow graph (cfg.h). Temps that are
+// set and used within one block are handled in that block alone, so the per-block sets
+// only cover variables and the few temps that cross blocks. Removing a store can make
+// the stores feeding it dead too, so the analysis is repeated until nothing changes.
+
+struct DeadCodeStats {
+    std::size_t quadsBefore = 0;
+    std::size_t quadsAfter = 0;
+    std::size_t deadDefinitions = 0;   // Computations and stores whose result is never read
+    std::size_t unreachableQuads = 0;  // Quads in blocks the entry cannot reach
+    std::size_t jumpsAndLabels = 0;    // Gotos to the next quad and labels nobody jumps to
+    std::size_t dataWordsRemoved = 0;  // Variables and temps that no longer need a DW
+    std::size_t rounds = 0;
+};
+
+// Rewrites `quads` in place. Fails only if they do not form a control-flow graph (see
+// buildCFG), setting `error` and leaving them untouched.
+bool eliminateDeadCode(std::vector<Quad>& quads, DeadCodeStats& stats, std::string& error);
+
+#endif // DEAD_CODE_H
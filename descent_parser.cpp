@@ -0,0 +1,306 @@
+#include "descent_parser.h"
+#include "compiler_context.h"
+
+// Token source and error sink shared with the bison parser (compiler_context.cpp).
+int yylex(YYSTYPE* value, CompilerContext* ctx);
+void yyerror(CompilerContext* ctx, const char* s);
+
+namespace {
+
+// --- Operator table ---
+// Binding powers follow the precedence lines of parser.y, loosest first:
+//   + -   <   * / %   <   == !=   <   < <= > >=
+// The comparisons are %nonassoc there, so two of the same level cannot be chained
+// ("a < b < c" is a syntax error at the second '<').
+
+struct BinaryOp {
+    int power;
+    OpKind op;
+    bool nonassoc;
+};
+
+bool binaryOp(int token, BinaryOp& out) {
+    switch (token) {
+        case PLUS:  out = {1, OpKind::Add, false}; return true;
+        case MINUS: out = {1, OpKind::Sub, false}; return true;
+        case MUL:   out = {2, OpKind::Mul, false}; return true;
+        case DIV:   out = {2, OpKind::Div, false}; return true;
+        case MOD:   out = {2, OpKind::Mod, false}; return true;
+        case EQ:    out = {3, OpKind::Eq, true}; return true;
+        case NE:    out = {3, OpKind::Ne, true}; return true;
+        case LT:    out = {4, OpKind::Lt, true}; return true;
+        case GT:    out = {4, OpKind::Gt, true}; return true;
+        case LE:    out = {4, OpKind::Le, true}; return true;
+        case GE:    out = {4, OpKind::Ge, true}; return true;
+        default:    return false;
+    }
+}
+
+bool startsExpr(int token) {
+    return token == NUMBER || token == IDENT || token == LPAREN || token == INCR || token == DECR;
+}
+
+bool startsStmt(int token) {
+    return startsExpr(token) || token == IF || token == WHILE || token == FOR ||
+           token == SWITCH || token == BREAK || token == LBRACE;
+}
+
+// --- Parser ---
+// `token` is always the one-token lookahead (what bison calls yychar). After the first
+// error it is set to YYerror, which starts and continues nothing, so every rule unwinds
+// without reading further input, just as yyparse returns without another yylex call.
+
+class DescentParser {
+public:
+    explicit DescentParser(CompilerContext& ctx) : ctx(ctx), arena(ctx.astArena), exprs(ctx.exprs) {}
+
+    bool parseProgram() {
+        advance();
+        ASTNode* program = stmtList();
+        if (token != 0) fail("syntax error");
+        if (failed) return false;
+        ctx.root = program;
+        return true;
+    }
+
+    // Top level of the same grammar, one statement at a time and without the spine.
+    bool parseStatements(const StatementHook& onStatement) {
+        advance();
+        do {
+            ASTNode* statement = stmt();
+            if (failed) return false;
+            if (!onStatement(statement)) return true;
+        } while (startsStmt(token));
+        if (token != 0) fail("syntax error");
+        return !failed;
+    }
+
+private:
+    void advance() {
+        if (!failed) token = yylex(&value, &ctx);
+    }
+
+    void fail(const char* message) {
+        if (failed) return;
+        failed = true;
+        token = YYerror;
+        yyerror(&ctx, message);
+    }
+
+    void expect(int expected) {
+        if (token == expected) advance();
+        else fail("syntax error");
+    }
+
+    // stmt_list: stmt+, as a left-leaning StmtList spine.
+    ASTNode* stmtList() {
+        ASTNode* list = stmt();
+        while (startsStmt(token)) {
+            ASTNode* next = stmt();
+            list = createNode(arena, NodeKind::StmtList, list, next);
+        }
+        return list;
+    }
+
+    ASTNode* stmt() {
+        if (++depth > kMaxDescentDepth) fail("memory exhausted");
+        ASTNode* result = stmtBody();
+        --depth;
+        return result;
+    }
+
+    ASTNode* stmtBody() {
+        switch (token) {
+            case IDENT: {
+                // IDENT ASSIGN expr ';' or an expression statement starting with IDENT.
+                Symbol name = value.sym;
+                advance();
+                if (token == ASSIGN) {
+                    advance();
+                    ASTNode* rhs = expr(0);
+                    expect(SEMICOLON);
+                    return createAssignNode(arena, name, rhs);
+                }
+                ASTNode* e = exprFrom(identifierExpr(name), 0);
+                expect(SEMICOLON);
+                return e;
+            }
+            case NUMBER:
+            case LPAREN:
+            case INCR:
+            case DECR: {
+                ASTNode* e = expr(0);
+                expect(SEMICOLON);
+                return e;
+            }
+            case IF: {
+                advance();
+                expect(LPAREN);
+                ASTNode* cond = expr(0);
+                expect(RPAREN);
+                ASTNode* thenStmt = stmt();
+                ASTNode* elseStmt = nullptr;
+                if (token == ELSE) {  // Binds to the nearest if, like bison's shift
+                    advance();
+                    elseStmt = stmt();
+                }
+                return createIfNode(arena, cond, thenStmt, elseStmt);
+            }
+            case WHILE: {
+                advance();
+                expect(LPAREN);
+                ASTNode* cond = expr(0);
+                expect(RPAREN);
+                ASTNode* body = stmt();
+                return createWhileNode(arena, cond, body);
+            }
+            case FOR: {
+                advance();
+                expect(LPAREN);
+                ASTNode* init = optExpr();
+                expect(SEMICOLON);
+                ASTNode* cond = optExpr();
+                expect(SEMICOLON);
+                ASTNode* inc = optExpr();
+                expect(RPAREN);
+                ASTNode* body = stmt();
+                return createForNode(arena, init, cond, inc, body);
+            }
+            case SWITCH: {
+                advance();
+                expect(LPAREN);
+                ASTNode* e = expr(0);
+                expect(RPAREN);
+                expect(LBRACE);
+                ASTNode* cases = caseList();
+                expect(RBRACE);
+                return createSwitchNode(arena, e, cases);
+            }
+            case BREAK:
+                advance();
+                expect(SEMICOLON);
+                return createNode(arena, NodeKind::Break, nullptr, nullptr);
+            case LBRACE: {
+                advance();
+                ASTNode* list = stmtList();
+                expect(RBRACE);
+                return list;
+            }
+            default:
+                fail("syntax error");
+                return nullptr;
+        }
+    }
+
+    // case_list: (CASE NUMBER ':' stmt_list | DEFAULT ':' stmt_list)*, newest entry on top.
+    ASTNode* caseList() {
+        ASTNode* cases = nullptr;
+        for (;;) {
+            if (token == CASE) {
+                advance();
+                int number = token == NUMBER ? value.ival : 0;
+                expect(NUMBER);
+                expect(COLON);
+                ASTNode* body = stmtList();
+                cases = createNode(arena, NodeKind::CaseListEntry, cases, createCaseNode(arena, number, body, nullptr));
+            } else if (token == DEFAULT) {
+                advance();
+                expect(COLON);
+                ASTNode* body = stmtList();
+                cases = createNode(arena, NodeKind::CaseListEntry, cases,
+                                   createNode(arena, NodeKind::DefaultCase, body, nullptr));
+            } else {
+                return cases;
+            }
+        }
+    }
+
+    ASTNode* optExpr() { return startsExpr(token) ? expr(0) : nullptr; }
+
+    ASTNode* expr(int minPower) { return exprFrom(primary(), minPower); }
+
+    // Extends `left` with every following binary operator of at least `minPower`.
+    ASTNode* exprFrom(ASTNode* left, int minPower) {
+        int chained = 0;  // Power of the operator last applied at this level
+        BinaryOp op;
+        while (binaryOp(token, op) && op.power >= minPower) {
+            if (op.nonassoc && op.power == chained) {
+                fail("syntax error");
+                break;
+            }
+            advance();
+            ASTNode* right = expr(op.power + 1);
+            left = exprs.op(op.op, left, right);
+            chained = op.power;
+        }
+        return left;
+    }
+
+    ASTNode* primary() {
+        switch (token) {
+            case NUMBER: {
+                int number = value.ival;
+                advance();
+                return exprs.num(number);
+            }
+            case IDENT: {
+                Symbol name = value.sym;
+                advance();
+                return identifierExpr(name);
+            }
+            case INCR:
+            case DECR: {
+                OpKind op = token == INCR ? OpKind::PreInc : OpKind::PreDec;
+                advance();
+                if (token != IDENT) {
+                    fail("syntax error");
+                    return nullptr;
+                }
+                Symbol name = value.sym;
+                advance();
+                return exprs.op(op, exprs.id(name), nullptr);
+            }
+            case LPAREN: {
+                if (++depth > kMaxDescentDepth) fail("memory exhausted");
+                advance();
+                ASTNode* e = expr(0);
+                expect(RPAREN);
+                --depth;
+                return e;
+            }
+            default:
+                fail("syntax error");
+                return nullptr;
+        }
+    }
+
+    // IDENT, IDENT INCR or IDENT DECR, with the identifier already consumed.
+    ASTNode* identifierExpr(Symbol name) {
+        if (token == INCR || token == DECR) {
+            OpKind op = token == INCR ? OpKind::PostInc : OpKind::PostDec;
+            advance();
+            return exprs.op(op, exprs.id(name), nullptr);
+        }
+        return exprs.id(name);
+    }
+
+    CompilerContext& ctx;
+    Arena& arena;
+    ExprFactory& exprs;
+    int token = 0;
+    YYSTYPE value;
+    bool failed = false;
+    int depth = 0;
+};
+
+} // end anonymous namespace
+
+bool parseDescent(CompilerContext& ctx) {
+    DescentParser parser(ctx);
+    return parser.parseProgram();
+}
+
+bool parseDescentStatements(CompilerContext& ctx, const StatementHook& onStatement) {
+    DescentParser parser(ctx);
+    return parser.parseStatements(onStatement);
+}
@@ -0,0 +1,33 @@
+#ifndef DESCENT_PARSER_H
+#define DESCENT_PARSER_H
+
+#include <functional>
+
+struct ASTNode;
+struct CompilerContext;
+
+// Hand-written alternative to the bison grammar in parser.y: recursive descent for
+// statements and precedence climbing (Pratt) for expressions. It accepts exactly the
+// same language, builds the same tree into ctx.astArena and reads tokens through the
+// same yylex, so it works with every ScannerKind. Like yyparse it stops at the first
+// error, reporting "syntax error" through yyerror on the same token bison would.
+//
+// Sets ctx.root and returns true on success. The one difference from bison is the
+// nesting limit: statements and parentheses nested more than kMaxDescentDepth deep are
+// reported as "memory exhausted", where bison's limit is its 10000-entry state stack.
+bool parseDescent(CompilerContext& ctx);
+
+constexpr int kMaxDescentDepth = 5000;
+
+// Called with each top-level statement as soon as it is complete (the parser has read
+// the token after it, so the scanner is positioned at the next statement). Returning
+// false stops the parse there.
+using StatementHook = std::function<bool(ASTNode* statement)>;
+
+// Same grammar, but each top-level statement goes to `onStatement` instead of into a
+// stmt_list spine, and ctx.root is left alone. Returns false on a syntax error; stopping
+// early from the hook counts as success. Used by IncrementalDocument to learn where
+// statements begin and end.
+bool parseDescentStatements(CompilerContext& ctx, const StatementHook& onStatement);
+
+#endif // DESCENT_PARSER_H
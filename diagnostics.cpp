@@ -0,0 +1,28 @@
+#include "diagnostics.h"
+#include <cstdarg>
+
+void Diagnostics::report(const char* format, ...) {
+    char stackBuffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(stackBuffer, sizeof(stackBuffer), format, args);
+    va_end(args);
+    if (length < 0) return;
+
+    size_t start = messages.size();
+    if ((size_t)length < sizeof(stackBuffer)) {
+        messages.append(stackBuffer, length);
+    } else {
+        messages.resize(start + length + 1);
+        va_start(args, format);
+        vsnprintf(&messages[start], length + 1, format, args);
+        va_end(args);
+        messages.resize(start + length);
+    }
+    ++reported;
+
+    if (echo) {
+        fwrite(messages.data() + start, 1, length, echo);
+        fflush(echo);
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <cstdio>  // For FILE
+#include <string>
+
+// Messages of one compilation (lexical, parse and semantic errors, and code generator
+// warnings), kept in reporting order. With an echo stream set, each message is also
+// written there as it is reported; the command-line driver echoes to stderr, library
+// users read text() instead.
+class Diagnostics {
+public:
+    void report(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    void setEcho(FILE* stream) { echo = stream; }
+    const std::string& text() const { return messages; }
+    int count() const { return reported; }
+    void clear() { messages.clear(); reported = 0; }
+
+private:
+    std::string messages;
+    int reported = 0;
+    FILE* echo = nullptr;
+};
+
+#endif // DIAGNOSTICS_H
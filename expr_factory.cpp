@@ -0,0 +1,93 @@
+#include "expr_factory.h"
+
+static bool isPure(OpKind op) {
+    return op != OpKind::PreInc && op != OpKind::PostInc && op != OpKind::PreDec && op != OpKind::PostDec;
+}
+
+static std::uint32_t payloadOf(const ASTNode* node) {
+    switch (node->kind) {
+        case NodeKind::Num: return static_cast<std::uint32_t>(node->num);
+        case NodeKind::Id:  return node->sym;
+        default:            return static_cast<std::uint32_t>(node->op);
+    }
+}
+
+static std::size_t hashOf(NodeKind kind, std::uint32_t payload, const ASTNode* left, const ASTNode* right) {
+    // Mix the fields 64 bits at a time (the multiplier is 2^64 / golden ratio).
+    std::uint64_t h = (static_cast<std::uint64_t>(kind) << 32) | payload;
+    h = (h ^ reinterpret_cast<std::uintptr_t>(left)) * 0x9E3779B97F4A7C15ull;
+    h = (h ^ reinterpret_cast<std::uintptr_t>(right)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<std::size_t>(h ^ (h >> 29));
+}
+
+static std::size_t hashOf(const ASTNode* node) {
+    return hashOf(node->kind, payloadOf(node), node->left, node->right);
+}
+
+// Finds the node with this identity, creating and remembering it on a miss.
+ASTNode* ExprFactory::shared(NodeKind kind, std::uint32_t payload, ASTNode* left, ASTNode* right) {
+    if (2 * (used + 1) > slots.size()) grow();
+    std::size_t mask = slots.size() - 1;
+    for (std::size_t i = hashOf(kind, payload, left, right) & mask;; i = (i + 1) & mask) {
+        ASTNode* node = slots[i];
+        if (!node) {
+            switch (kind) {
+                case NodeKind::Num: node = createNumNode(arena, static_cast<int>(payload)); break;
+                case NodeKind::Id:  node = createIdNode(arena, payload); break;
+                default:            node = createOpNode(arena, static_cast<OpKind>(payload), left, right); break;
+            }
+            slots[i] = node;
+            ++used;
+            ++creations;
+            return node;
+        }
+        if (node->kind == kind && payloadOf(node) == payload && node->left == left && node->right == right)
+            return node;
+    }
+}
+
+void ExprFactory::grow() {
+    std::vector<ASTNode*> old(slots.size() ? 2 * slots.size() : 1024, nullptr);
+    old.swap(slots);
+    std::size_t mask = slots.size() - 1;
+    for (ASTNode* node : old) {
+        if (!node) continue;
+        std::size_t i = hashOf(node) & mask;
+        while (slots[i]) i = (i + 1) & mask;
+        slots[i] = node;
+    }
+}
+
+ASTNode* ExprFactory::num(int value) {
+    ++requests;
+    if (!sharing) {
+        ++creations;
+        return createNumNode(arena, value);
+    }
+    return shared(NodeKind::Num, static_cast<std::uint32_t>(value), nullptr, nullptr);
+}
+
+ASTNode* ExprFactory::id(Symbol name) {
+    ++requests;
+    if (!sharing) {
+        ++creations;
+        return createIdNode(arena, name);
+    }
+    return shared(NodeKind::Id, name, nullptr, nullptr);
+}
+
+ASTNode* ExprFactory::op(OpKind op, ASTNode* left, ASTNode* right) {
+    ++requests;
+    if (!sharing || !isPure(op)) {
+        ++creations;
+        return createOpNode(arena, op, left, right);
+    }
+    return shared(NodeKind::Op, static_cast<std::uint32_t>(op), left, right);
+}
+
+void ExprFactory::clear() {
+    slots.clear();
+    used = 0;
+    requests = 0;
+    creations = 0;
+}
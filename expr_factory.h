@@ -0,0 +1,61 @@
+#ifndef EXPR_FACTORY_H
+#define EXPR_FACTORY_H
+
+#include "ast.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Creates the expression nodes of one compilation. Both parsers build Num, Id and Op
+// nodes through it, so turning on sharing affects whichever parser runs.
+//
+// Without sharing every call returns a fresh node, as createNumNode and friends do.
+// With sharing (hash-consing), pure expressions are kept in a table and each
+// structurally distinct one exists once: every `1`, every `x` and every `a + b` in the
+// program is the same node, and the tree becomes a DAG. Increments and decrements
+// change a variable, so they always get a node of their own (their Id operand is
+// still shared).
+//
+// A shared node means "the same expression text", not "the same value": `a + b`
+// before and after an assignment to `a` is one node. Lowering walks the DAG as if it
+// were a tree and emits each use separately. Shared nodes must never be changed in
+// place.
+class ExprFactory {
+public:
+    explicit ExprFactory(Arena& arena) : arena(arena) {}
+
+    ExprFactory(const ExprFactory&) = delete;
+    ExprFactory& operator=(const ExprFactory&) = delete;
+
+    // Takes effect for nodes created from now on. Turn it on before parsing.
+    void setSharing(bool on) { sharing = on; }
+    bool isSharing() const { return sharing; }
+
+    ASTNode* num(int value);
+    ASTNode* id(Symbol name);
+    ASTNode* op(OpKind op, ASTNode* left, ASTNode* right);
+
+    // Forgets the shared nodes. Call it whenever the arena is reset.
+    void clear();
+
+    // Number of nodes requested, and how many of those were actually allocated.
+    std::size_t requested() const { return requests; }
+    std::size_t created() const { return creations; }
+
+private:
+    // A node's identity is its kind, its payload (literal, symbol or operator) and its
+    // children. The children are canonical already, so their addresses identify them.
+    ASTNode* shared(NodeKind kind, std::uint32_t payload, ASTNode* left, ASTNode* right);
+    void grow();
+
+    Arena& arena;
+    bool sharing = false;
+    // Open-addressed set of the shared nodes (linear probing, at most half full). The
+    // nodes are their own keys, so a slot is one pointer.
+    std::vector<ASTNode*> slots;
+    std::size_t used = 0;
+    std::size_t requests = 0;
+    std::size_t creations = 0;
+};
+
+#endif // EXPR_FACTORY_H
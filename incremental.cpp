@@ -0,0 +1,148 @@
+#include "incremental.h"
+#include "descent_parser.h"
+
+// Once the arena holds this many times the tree of the last full parse (plus the
+// slack), the next edit parses from scratch into an emptied arena.
+static const std::size_t kArenaGrowthLimit = 4;
+static const std::size_t kArenaSlackBytes = 1 << 20;
+
+// Whether an `else` written after `node` would become part of it, i.e. the statement
+// ends in an if without an else (possibly as a loop body or an else branch). A block
+// holding one statement looks like that statement, so the answer can be a false yes,
+// which only costs reparsing one more statement.
+static bool mayTakeElse(const ASTNode* node) {
+    while (node) {
+        switch (node->kind) {
+            case NodeKind::If:
+                if (!node->third) return true;
+                node = node->third;
+                break;
+            case NodeKind::While: node = node->right; break;
+            case NodeKind::For:   node = node->fourth; break;
+            default:              return false;
+        }
+    }
+    return false;
+}
+
+void IncrementalDocument::setText(std::string_view text) {
+    source.assign(text.data(), text.size());
+    parseAll();
+}
+
+void IncrementalDocument::parseAll() {
+    ctx.reset();
+    ctx.scannerKind = ScannerKind::Builtin;
+    ctx.exprs.setSharing(true);
+    statements.clear();
+
+    ctx.scanner.reset(source);
+    std::size_t spanStart = 0;
+    bool ok = parseDescentStatements(ctx, [&](ASTNode* node) {
+        std::size_t end = ctx.scanner.tokenStart() - source.data();
+        statements.push_back({end - spanStart, node, nullptr});
+        spanStart = end;
+        return true;
+    });
+
+    parsed = ok;
+    parseMessages = ctx.diagnostics.text();
+    if (parsed) relinkSpine(0);
+    else statements.clear();
+    liveBytes = ctx.astArena.bytesAllocated();
+    stats.fullParse = true;
+    stats.reparsed = statements.size();
+    stats.reused = 0;
+}
+
+bool IncrementalDocument::edit(std::size_t offset, std::size_t removed, std::string_view inserted) {
+    if (offset > source.size() || removed > source.size() - offset) return false;
+    if (!parsed || !parseMessages.empty() || ctx.astArena.bytesAllocated() > kArenaGrowthLimit * liveBytes + kArenaSlackBytes) {
+        source.replace(offset, removed, inserted.data(), inserted.size());
+        parseAll();
+        return true;
+    }
+
+    // The statements whose spans hold the first and the last edited byte. An edit ending
+    // right at a span's start counts, since inserted text can join its first token.
+    std::size_t editEnd = offset + removed;
+    std::size_t first = 0;
+    std::size_t firstBegin = 0;
+    while (first + 1 < statements.size() && firstBegin + statements[first].length <= offset)
+        firstBegin += statements[first++].length;
+    std::size_t last = first;
+    std::size_t lastEnd = firstBegin + statements[first].length;
+    while (last + 1 < statements.size() && lastEnd <= editEnd)
+        lastEnd += statements[++last].length;
+    // The statement before can change too if the edit may start with an `else` for it.
+    if (first > 0 && (offset == firstBegin || mayTakeElse(statements[first - 1].node)))
+        firstBegin -= statements[--first].length;
+
+    source.replace(offset, removed, inserted.data(), inserted.size());
+
+    // Parse from `first` until a statement ends exactly where an old statement after
+    // `last` starts (shifted by the edit): the text from there on is unchanged, and so is
+    // its parse, since a statement's parse never depends on what comes before it.
+    std::size_t next = last + 1;
+    std::size_t nextBegin = lastEnd - removed + inserted.size();
+    std::vector<Statement> reparsed;
+    std::size_t spanStart = firstBegin;
+    ctx.diagnostics.clear();  // Leftovers of the last compile()
+    ctx.scanner.reset(std::string_view(source).substr(firstBegin));
+    bool ok = parseDescentStatements(ctx, [&](ASTNode* node) {
+        std::size_t end = ctx.scanner.tokenStart() - source.data();
+        reparsed.push_back({end - spanStart, node, nullptr});
+        spanStart = end;
+        while (next < statements.size() && nextBegin < end) nextBegin += statements[next++].length;
+        return !(next < statements.size() && nextBegin == end);
+    });
+    if (!ok || ctx.diagnostics.count() > 0) {
+        // Messages carry line numbers relative to `firstBegin`; redo them from the top.
+        parseAll();
+        return true;
+    }
+
+    stats.fullParse = false;
+    stats.reparsed = reparsed.size();
+    stats.reused = statements.size() - (next - first);
+    statements.erase(statements.begin() + first, statements.begin() + next);
+    statements.insert(statements.begin() + first, reparsed.begin(), reparsed.end());
+    relinkSpine(first);
+    return true;
+}
+
+// Rebuilds the stmt_list spine (the shape parser.y gives it) from statement `from` on.
+// Reused statements keep their StmtList nodes, so only the first one after the new
+// statements needs its left link moved; the rest of the spine is still intact.
+void IncrementalDocument::relinkSpine(std::size_t from) {
+    for (std::size_t i = from; i < statements.size(); ++i) {
+        Statement& statement = statements[i];
+        if (i == 0) {
+            statement.spine = statement.node;
+            continue;
+        }
+        ASTNode* previous = statements[i - 1].spine;
+        if (statement.spine && statement.spine != statement.node) {
+            if (statement.spine->left == previous) return;
+            statement.spine->left = previous;
+        } else {
+            statement.spine = createNode(ctx.astArena, NodeKind::StmtList, previous, statement.node);
+        }
+    }
+}
+
+CompileResult IncrementalDocument::compile(const CompileOptions& options) {
+    CompileResult result;
+    if (parsed) {
+        // Fresh numbering and messages, as in a context of its own, after the parse's.
+        ctx.diagnostics.clear();
+        if (!parseMessages.empty()) ctx.diagnostics.report("%s", parseMessages.c_str());
+        ctx.tac = TACState();
+        ctx.tac.diagnostics = &ctx.diagnostics;
+        ctx.root = statements.back().spine;
+        result.ok = true;
+        compileParsed(ctx, options, result);
+    }
+    result.diagnostics = parsed ? ctx.diagnostics.text() : parseMessages;
+    return result;
+}
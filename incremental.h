@@ -0,0 +1,75 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "compiler_context.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A program that is edited and recompiled over and over (the web editor's buffer).
+// The document remembers where each top-level statement's text begins and ends and
+// keeps that statement's subtree. An edit relexes and reparses only the statements
+// whose text it touches, plus the one before them if an inserted `else` could attach
+// to it. Parsing continues past them until it lands on the start of an untouched
+// statement again, and everything from there on is reused as it is. Parsing therefore
+// costs time in proportion to the edited statements, not to the document. Lowering
+// and code generation in compile() still run on the whole tree.
+//
+// Only parses without messages are reused. A document with a syntax or lexical error is
+// parsed from scratch on every edit until it is clean again, so its messages (with their
+// line numbers) are exactly those of a fresh compile. Edits leave replaced subtrees behind
+// in the arena, so once it holds several times the live tree the next edit starts
+// over from scratch too. Expressions are hash-consed (see ExprFactory), so retyping
+// a statement adds nodes only for expressions the document did not contain yet.
+class IncrementalDocument {
+public:
+    // What the last setText() or edit() did.
+    struct EditStats {
+        bool fullParse = false;      // Parsed the whole document
+        std::size_t reparsed = 0;    // Top-level statements parsed
+        std::size_t reused = 0;      // Top-level statements kept from the previous tree
+    };
+
+    IncrementalDocument() = default;
+    IncrementalDocument(const IncrementalDocument&) = delete;
+    IncrementalDocument& operator=(const IncrementalDocument&) = delete;
+
+    // Replaces the whole text and parses it from scratch.
+    void setText(std::string_view text);
+
+    // Replaces the `removed` bytes at `offset` with `inserted` and reparses what changed.
+    // Returns false (changing nothing) if the range is not inside the text.
+    bool edit(std::size_t offset, std::size_t removed, std::string_view inserted);
+
+    const std::string& text() const { return source; }
+    const EditStats& lastEdit() const { return stats; }
+
+    // Compiles the current tree, as ::compile(text(), options) would (options.scanner,
+    // options.parser and options.shareExpressions are ignored: documents always use the
+    // builtin scanner and the descent parser, which can report statement boundaries).
+    CompileResult compile(const CompileOptions& options);
+
+private:
+    // One top-level statement. Spans tile the text: each runs from where the previous
+    // one ends (0 for the first) to the first token of the next (the text's end for
+    // the last), so trailing whitespace belongs to the statement before it.
+    struct Statement {
+        std::size_t length;  // Bytes of text in the span
+        ASTNode* node;       // The statement's subtree
+        ASTNode* spine;      // StmtList node joining it to the ones before (the node itself for the first)
+    };
+
+    void parseAll();
+    void relinkSpine(std::size_t from);
+
+    std::string source;
+    CompilerContext ctx;
+    std::vector<Statement> statements;
+    bool parsed = false;         // statements describe the text (the last parse succeeded)
+    std::string parseMessages;   // Messages of the last full parse (lexical errors, or the syntax error)
+    std::size_t liveBytes = 0;   // Arena use right after the last full parse
+    EditStats stats;
+};
+
+#endif // INCREMENTAL_H
@@ -0,0 +1,331 @@
+#include "ir_file.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<PackedNode>::value && std::is_trivially_copyable<Quad>::value,
+              "IR records are written and mapped back byte for byte");
+
+namespace {
+
+const char kMagic[8] = {'M', 'C', '8', '6', 'I', 'R', '\0', '\0'};
+const std::uint32_t kByteOrderMark = 0x01020304;
+const std::uint32_t kMaxSections = 16;
+// Deepest AST nesting accepted, the same as bison's stack limit. Lowering recurses once
+// per level, so a crafted file must not be allowed to go deeper than a parse could.
+const std::uint32_t kMaxNesting = 10000;
+
+enum SectionId : std::uint32_t {
+    kSymbolOffsets = 1,
+    kSymbolText = 2,
+    kAstNodes = 3,
+    kAstExtras = 4,
+    kQuads = 5,
+};
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t sectionCount;
+    std::uint32_t zero;
+};
+
+struct SectionEntry {
+    std::uint32_t id;
+    std::uint32_t recordSize;
+    std::uint64_t offset;
+    std::uint64_t count;
+};
+
+// One section to write. `write` puts exactly recordSize * count bytes on the stream.
+struct PendingSection {
+    SectionEntry entry;
+    const void* data;           // Records that can be written as they are, or...
+    bool (*write)(FILE*, const void*, std::size_t);  // ...a writer that zeroes their padding
+};
+
+std::uint64_t alignUp(std::uint64_t offset) {
+    return (offset + 7) & ~std::uint64_t(7);
+}
+
+// Writes `count` records through a zeroed buffer, copying only the fields, so that
+// padding bytes in the file are zeros and not whatever memory held.
+bool writePackedNodes(FILE* out, const void* data, std::size_t count) {
+    const PackedNode* nodes = static_cast<const PackedNode*>(data);
+    PackedNode chunk[1024];
+    for (std::size_t done = 0; done < count;) {
+        std::size_t n = std::min<std::size_t>(count - done, 1024);
+        std::memset(static_cast<void*>(chunk), 0, sizeof(chunk));
+        for (std::size_t i = 0; i < n; ++i) {
+            const PackedNode& node = nodes[done + i];
+            chunk[i].kind = node.kind;
+            chunk[i].payload = node.payload;
+            chunk[i].left = node.left;
+            chunk[i].right = node.right;
+        }
+        if (fwrite(chunk, sizeof(PackedNode), n, out) != n) return false;
+        done += n;
+    }
+    return true;
+}
+
+bool writeQuads(FILE* out, const void* data, std::size_t count) {
+    const Quad* quads = static_cast<const Quad*>(data);
+    Quad chunk[1024];
+    auto copy = [](Operand& to, const Operand& from) {
+        to.kind = from.kind;
+        to.value = from.value;
+    };
+    for (std::size_t done = 0; done < count;) {
+        std::size_t n = std::min<std::size_t>(count - done, 1024);
+        std::memset(static_cast<void*>(chunk), 0, sizeof(chunk));
+        for (std::size_t i = 0; i < n; ++i) {
+            const Quad& quad = quads[done + i];
+            chunk[i].op = quad.op;
+            copy(chunk[i].arg1, quad.arg1);
+            copy(chunk[i].arg2, quad.arg2);
+            copy(chunk[i].result, quad.result);
+        }
+        if (fwrite(chunk, sizeof(Quad), n, out) != n) return false;
+        done += n;
+    }
+    return true;
+}
+
+} // end anonymous namespace
+
+// --- Writing ---
+
+bool writeIRFile(const std::string& path, const SymbolTable& symbols, const PackedAST* ast,
+                 const std::vector<Quad>* quads, std::string& error) {
+    std::vector<std::uint32_t> offsets{0};
+    std::string text;
+    for (Symbol id = 0; id < symbols.size(); ++id) {
+        text += symbols.name(id);
+        if (text.size() > UINT32_MAX) {
+            error = "identifiers too long for the IR format";
+            return false;
+        }
+        offsets.push_back(static_cast<std::uint32_t>(text.size()));
+    }
+
+    std::vector<PendingSection> sections;
+    sections.push_back({{kSymbolOffsets, sizeof(std::uint32_t), 0, offsets.size()}, offsets.data(), nullptr});
+    sections.push_back({{kSymbolText, 1, 0, text.size()}, text.data(), nullptr});
+    if (ast && !ast->empty()) {
+        sections.push_back({{kAstNodes, sizeof(PackedNode), 0, ast->nodes.size()}, ast->nodes.data(), writePackedNodes});
+        sections.push_back({{kAstExtras, sizeof(PackedExtra), 0, ast->extras.size()}, ast->extras.data(), nullptr});
+    }
+    if (quads) sections.push_back({{kQuads, sizeof(Quad), 0, quads->size()}, quads->data(), writeQuads});
+
+    std::uint64_t offset = sizeof(Header) + sections.size() * sizeof(SectionEntry);
+    for (PendingSection& section : sections) {
+        offset = alignUp(offset);
+        section.entry.offset = offset;
+        offset += section.entry.recordSize * section.entry.count;
+    }
+
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out) {
+        error = strerror(errno);
+        return false;
+    }
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kIRVersion;
+    header.byteOrder = kByteOrderMark;
+    header.sectionCount = static_cast<std::uint32_t>(sections.size());
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    for (const PendingSection& section : sections)
+        ok = ok && fwrite(&section.entry, sizeof(SectionEntry), 1, out) == 1;
+
+    std::uint64_t written = sizeof(Header) + sections.size() * sizeof(SectionEntry);
+    static const char zeros[8] = {};
+    for (const PendingSection& section : sections) {
+        if (!ok) break;
+        ok = fwrite(zeros, 1, section.entry.offset - written, out) == section.entry.offset - written;
+        std::size_t count = static_cast<std::size_t>(section.entry.count);
+        if (section.write) ok = ok && section.write(out, section.data, count);
+        else if (count) ok = ok && fwrite(section.data, section.entry.recordSize, count, out) == count;
+        written = section.entry.offset + section.entry.recordSize * section.entry.count;
+    }
+    if (fclose(out) != 0) ok = false;
+    if (!ok) error = strerror(errno ? errno : EIO);
+    return ok;
+}
+
+// --- Reading ---
+
+void IRFile::clear() {
+    symbols = 0;
+    symbolOffsets = nullptr;
+    symbolText = nullptr;
+    ast = PackedASTView();
+    quadData = nullptr;
+    quadTotal = 0;
+    hasQuadSection = false;
+}
+
+bool IRFile::fail(std::string& error, const std::string& reason) {
+    error = reason;
+    clear();
+    return false;
+}
+
+bool IRFile::open(const char* path, std::string& error) {
+    clear();
+    if (!file.open(path, error)) return false;
+
+    const char* base = file.data();
+    std::uint64_t size = file.size();
+    Header header;
+    if (size < sizeof(header)) return fail(error, "not an IR file");
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) return fail(error, "not an IR file");
+    if (header.byteOrder != kByteOrderMark)
+        return fail(error, "IR file written on a machine with a different byte order");
+    if (header.version != kIRVersion)
+        return fail(error, "IR file version " + std::to_string(header.version) + ", expected " +
+                               std::to_string(kIRVersion));
+    if (header.sectionCount > kMaxSections || size < sizeof(header) + header.sectionCount * sizeof(SectionEntry))
+        return fail(error, "corrupt IR file (section table)");
+
+    std::uint64_t seen = 0;
+    const void* sectionData[kQuads + 1] = {};
+    std::uint64_t sectionCount[kQuads + 1] = {};
+    for (std::uint32_t i = 0; i < header.sectionCount; ++i) {
+        SectionEntry entry;
+        std::memcpy(&entry, base + sizeof(header) + i * sizeof(SectionEntry), sizeof(entry));
+        std::uint32_t expectedSize = 0;
+        switch (entry.id) {
+            case kSymbolOffsets: expectedSize = sizeof(std::uint32_t); break;
+            case kSymbolText:    expectedSize = 1; break;
+            case kAstNodes:      expectedSize = sizeof(PackedNode); break;
+            case kAstExtras:     expectedSize = sizeof(PackedExtra); break;
+            case kQuads:         expectedSize = sizeof(Quad); break;
+            default:             return fail(error, "corrupt IR file (unknown section " + std::to_string(entry.id) + ")");
+        }
+        if (entry.recordSize != expectedSize)
+            return fail(error, "IR file records do not match this build (section " + std::to_string(entry.id) + ")");
+        if (seen & (std::uint64_t(1) << entry.id)) return fail(error, "corrupt IR file (repeated section)");
+        seen |= std::uint64_t(1) << entry.id;
+        if (entry.offset % 8 != 0 || entry.offset > size || entry.count > (size - entry.offset) / entry.recordSize)
+            return fail(error, "truncated IR file");
+        sectionData[entry.id] = base + entry.offset;
+        sectionCount[entry.id] = entry.count;
+    }
+
+    // Identifiers (always present).
+    if (!sectionData[kSymbolOffsets] || !sectionData[kSymbolText] || sectionCount[kSymbolOffsets] == 0)
+        return fail(error, "corrupt IR file (no symbol table)");
+    symbols = static_cast<std::size_t>(sectionCount[kSymbolOffsets] - 1);
+    symbolOffsets = static_cast<const std::uint32_t*>(sectionData[kSymbolOffsets]);
+    symbolText = static_cast<const char*>(sectionData[kSymbolText]);
+    if (symbolOffsets[0] != 0 || symbolOffsets[symbols] != sectionCount[kSymbolText])
+        return fail(error, "corrupt IR file (symbol table)");
+    for (std::size_t i = 0; i < symbols; ++i) {
+        if (symbolOffsets[i] > symbolOffsets[i + 1]) return fail(error, "corrupt IR file (symbol table)");
+    }
+
+    if (sectionData[kAstNodes] && sectionCount[kAstNodes] > 0) {
+        if (sectionCount[kAstNodes] >= kNoPackedNode || !sectionData[kAstExtras])
+            return fail(error, "corrupt IR file (AST)");
+        ast.nodes = static_cast<const PackedNode*>(sectionData[kAstNodes]);
+        ast.nodeCount = static_cast<std::size_t>(sectionCount[kAstNodes]);
+        ast.extras = static_cast<const PackedExtra*>(sectionData[kAstExtras]);
+        ast.extraCount = static_cast<std::size_t>(sectionCount[kAstExtras]);
+        ast.root = static_cast<std::uint32_t>(ast.nodeCount - 1);
+        if (!checkAST(error)) return false;
+    }
+
+    if (sectionData[kQuads]) {
+        hasQuadSection = true;
+        quadData = static_cast<const Quad*>(sectionData[kQuads]);
+        quadTotal = static_cast<std::size_t>(sectionCount[kQuads]);
+        if (!checkQuads(error)) return false;
+    }
+    return true;
+}
+
+// Every child comes before its parent (post-order) and has one parent, so the AST is a
+// tree and lowering it takes linear time; payloads are in range for the node kind.
+bool IRFile::checkAST(std::string& error) {
+    std::vector<std::uint32_t> nesting(ast.nodeCount, 0);
+    std::vector<bool> referenced(ast.nodeCount, false);
+    for (std::uint32_t i = 0; i < ast.nodeCount; ++i) {
+        const PackedNode& node = ast.nodes[i];
+        if (node.kind > NodeKind::Break) return fail(error, "corrupt IR file (AST node kind)");
+
+        std::uint32_t children[4] = {node.left, node.right, kNoPackedNode, kNoPackedNode};
+        std::uint32_t payload = static_cast<std::uint32_t>(node.payload);
+        switch (node.kind) {
+            case NodeKind::Id:
+            case NodeKind::Assign:
+                if (payload >= symbols) return fail(error, "corrupt IR file (AST symbol)");
+                break;
+            case NodeKind::Op:
+                if (payload > static_cast<std::uint32_t>(OpKind::PostDec)) return fail(error, "corrupt IR file (AST operator)");
+                break;
+            case NodeKind::If:
+            case NodeKind::For:
+                if (payload >= ast.extraCount) return fail(error, "corrupt IR file (AST node)");
+                children[2] = ast.extras[payload][0];
+                children[3] = ast.extras[payload][1];
+                break;
+            default:
+                break;
+        }
+
+        // Lists are walked iteratively (stmt_list spines and case lists along `left`),
+        // so only other links add a level.
+        bool list = node.kind == NodeKind::StmtList || node.kind == NodeKind::CaseListEntry;
+        for (int c = 0; c < 4; ++c) {
+            std::uint32_t child = children[c];
+            if (child == kNoPackedNode) continue;
+            if (child >= i || referenced[child]) return fail(error, "corrupt IR file (AST is not a tree)");
+            referenced[child] = true;
+            std::uint32_t depth = nesting[child] + (list && c == 0 ? 0 : 1);
+            if (depth > nesting[i]) nesting[i] = depth;
+        }
+        if (nesting[i] > kMaxNesting) return fail(error, "IR file AST nested too deeply");
+    }
+    return true;
+}
+
+// generate8086 indexes tables by variable, temp and label number; keep them in range.
+// Each temp and label of a compilation is the result of one of its quads, so in a file
+// written after a fresh lowering (or after optimizeQuads, which renumbers them) no number
+// exceeds the quad count.
+bool IRFile::checkQuads(std::string& error) {
+    std::int64_t limit = static_cast<std::int64_t>(quadTotal);
+    auto valid = [&](const Operand& operand) {
+        switch (operand.kind) {
+            case OperandKind::None:
+            case OperandKind::Imm:
+                return true;
+            case OperandKind::Var:
+                return operand.value >= 0 && static_cast<std::size_t>(operand.value) < symbols;
+            case OperandKind::Temp:
+            case OperandKind::Label:
+                return operand.value >= 0 && operand.value <= limit;
+        }
+        return false;
+    };
+    for (std::size_t i = 0; i < quadTotal; ++i) {
+        const Quad& quad = quadData[i];
+        if (quad.op > QuadOp::If || !valid(quad.arg1) || !valid(quad.arg2) || !valid(quad.result))
+            return fail(error, "corrupt IR file (quad " + std::to_string(i) + ")");
+    }
+    return true;
+}
+
+std::string_view IRFile::symbolName(Symbol id) const {
+    return std::string_view(symbolText + symbolOffsets[id], symbolOffsets[id + 1] - symbolOffsets[id]);
+}
+
+void IRFile::loadSymbols(SymbolTable& table) const {
+    for (Symbol id = 0; id < symbols; ++id) table.intern(symbolName(id));
+}
@@ -0,0 +1,78 @@
+#ifndef IR_FILE_H
+#define IR_FILE_H
+
+#include "packed_ast.h"
+#include "source_file.h"
+#include "symbol_table.h"
+#include "three_address_code.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// --- Binary IR files ---
+// What the front end produced for one program: its identifiers, its AST (packed, see
+// packed_ast.h) and/or its quads. The records are stored in the same layout they have
+// in memory, so a file that is mapped back can be read in place. The AST is read
+// through PackedASTView and the quads go straight to generate8086. Nothing is decoded.
+// `compiler --write-ir=FILE` writes one, and `compiler --read-ir FILE` resumes from it.
+//
+// Layout (host byte order; each section starts on an 8-byte boundary):
+//   header   "MC86IR\0\0", u32 version, u32 byte-order mark 0x01020304,
+//            u32 section count, u32 zero
+//   table    per section: u32 id, u32 record size, u64 offset, u64 record count
+//   sections SymbolOffsets  u32 x (symbols + 1): where each name starts in SymbolText
+//            SymbolText     the names back to back, no terminators
+//            AstNodes       PackedNode records in post-order (the root is the last)
+//            AstExtras      PackedExtra records
+//            Quads          Quad records, padding zeroed
+// A reader rejects a file whose version, byte order or record sizes differ from its own,
+// so a file only moves between builds of the same version on the same kind of machine.
+
+constexpr std::uint32_t kIRVersion = 1;
+
+// Writes `symbols` plus whichever of `ast` and `quads` is not null to `path`. On failure
+// returns false and sets `error` (strerror text, printed as "<path>: <reason>").
+bool writeIRFile(const std::string& path, const SymbolTable& symbols, const PackedAST* ast,
+                 const std::vector<Quad>* quads, std::string& error);
+
+// A mapped IR file. Everything it hands out points into the mapping and stays valid
+// until the next open() or the object is destroyed.
+class IRFile {
+public:
+    // Maps `path` and checks it completely: the header and section table, every child
+    // index and symbol reference of the AST, and every opcode and operand of the quads.
+    // The stages after it can then trust the contents. On failure returns false and
+    // sets `error`.
+    bool open(const char* path, std::string& error);
+
+    std::size_t symbolCount() const { return symbols; }
+    std::string_view symbolName(Symbol id) const;
+    // Interns every name in order, so the ids of `table` (which must be empty) match the file's.
+    void loadSymbols(SymbolTable& table) const;
+
+    bool hasAST() const { return ast.root != kNoPackedNode; }
+    const PackedASTView& astView() const { return ast; }
+
+    bool hasQuads() const { return hasQuadSection; }
+    const Quad* quads() const { return quadData; }
+    std::size_t quadCount() const { return quadTotal; }
+
+private:
+    void clear();
+    bool fail(std::string& error, const std::string& reason);
+    bool checkAST(std::string& error);
+    bool checkQuads(std::string& error);
+
+    SourceFile file;
+    std::size_t symbols = 0;
+    const std::uint32_t* symbolOffsets = nullptr;
+    const char* symbolText = nullptr;
+    PackedASTView ast;
+    bool hasQuadSection = false;
+    const Quad* quadData = nullptr;
+    std::size_t quadTotal = 0;
+};
+
+#endif // IR_FILE_H
@@ -516,11 +516,19 @@ char *yytext;
 #line 2 "lexer.l"
 #include "ast.h"
 #include "parser.tab.h"
+#include "compiler_context.h"
+#include "verbosity.h"
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#line 523 "lex.yy.c"
-#line 524 "lex.yy.c"
+
+// The parser is pure, so the scanner receives the semantic value and the context
+// explicitly. flex itself still keeps its buffer state in globals; see flexBeginSource().
+#define YY_DECL int flexLex(YYSTYPE* lvalp, CompilerContext* ctx)
+#define yylval (*lvalp)
+#line 531 "lex.yy.c"
+#line 532 "lex.yy.c"
 
 #define INITIAL 0
 
@@ -737,10 +745,10 @@ YY_DECL
 		}
 
 	{
-#line 12 "lexer.l"
+#line 20 "lexer.l"
 
 
-#line 744 "lex.yy.c"
+#line 752 "lex.yy.c"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -809,190 +817,186 @@ do_action:	/* This label is used only to access EOF actions. */
 
 case 1:
 YY_RULE_SETUP
-#line 14 "lexer.l"
-{ printf("LEX: IF\n"); return IF; }
+#line 22 "lexer.l"
+{ LOG_TRACE("LEX: IF\n"); return IF; }
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 15 "lexer.l"
-{ printf("LEX: ELSE\n"); return ELSE; }
+#line 23 "lexer.l"
+{ LOG_TRACE("LEX: ELSE\n"); return ELSE; }
 	YY_BREAK
 case 3:
 YY_RULE_SETUP
-#line 16 "lexer.l"
-{ printf("LEX: WHILE\n"); return WHILE; }
+#line 24 "lexer.l"
+{ LOG_TRACE("LEX: WHILE\n"); return WHILE; }
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 17 "lexer.l"
-{ printf("LEX: FOR\n"); return FOR; }
+#line 25 "lexer.l"
+{ LOG_TRACE("LEX: FOR\n"); return FOR; }
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 18 "lexer.l"
-{ printf("LEX: SWITCH\n"); return SWITCH; }
+#line 26 "lexer.l"
+{ LOG_TRACE("LEX: SWITCH\n"); return SWITCH; }
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 19 "lexer.l"
-{ printf("LEX: CASE\n"); return CASE; }
+#line 27 "lexer.l"
+{ LOG_TRACE("LEX: CASE\n"); return CASE; }
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 20 "lexer.l"
-{ printf("LEX: DEFAULT\n"); return DEFAULT; }
+#line 28 "lexer.l"
+{ LOG_TRACE("LEX: DEFAULT\n"); return DEFAULT; }
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 21 "lexer.l"
-{ printf("LEX: BREAK\n"); return BREAK; }
+#line 29 "lexer.l"
+{ LOG_TRACE("LEX: BREAK\n"); return BREAK; }
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 23 "lexer.l"
-{ printf("LEX: INCR ('%s')\n", yytext); return INCR; }
+#line 31 "lexer.l"
+{ LOG_TRACE("LEX: INCR ('%s')\n", yytext); return INCR; }
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 24 "lexer.l"
-{ printf("LEX: DECR ('%s')\n", yytext); return DECR; }
+#line 32 "lexer.l"
+{ LOG_TRACE("LEX: DECR ('%s')\n", yytext); return DECR; }
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 26 "lexer.l"
-{ printf("LEX: EQ\n"); return EQ; }
+#line 34 "lexer.l"
+{ LOG_TRACE("LEX: EQ\n"); return EQ; }
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 27 "lexer.l"
-{ printf("LEX: NE\n"); return NE; }
+#line 35 "lexer.l"
+{ LOG_TRACE("LEX: NE\n"); return NE; }
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 28 "lexer.l"
-{ printf("LEX: LE\n"); return LE; }
+#line 36 "lexer.l"
+{ LOG_TRACE("LEX: LE\n"); return LE; }
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 29 "lexer.l"
-{ printf("LEX: GE\n"); return GE; }
+#line 37 "lexer.l"
+{ LOG_TRACE("LEX: GE\n"); return GE; }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 30 "lexer.l"
-{ printf("LEX: LT\n"); return LT; }
+#line 38 "lexer.l"
+{ LOG_TRACE("LEX: LT\n"); return LT; }
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 31 "lexer.l"
-{ printf("LEX: GT\n"); return GT; }
+#line 39 "lexer.l"
+{ LOG_TRACE("LEX: GT\n"); return GT; }
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 32 "lexer.l"
-{ printf("LEX: ASSIGN\n"); return ASSIGN; }
+#line 40 "lexer.l"
+{ LOG_TRACE("LEX: ASSIGN\n"); return ASSIGN; }
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 34 "lexer.l"
-{ printf("LEX: PLUS ('%s')\n", yytext); return PLUS; }
+#line 42 "lexer.l"
+{ LOG_TRACE("LEX: PLUS ('%s')\n", yytext); return PLUS; }
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
-#line 35 "lexer.l"
-{ printf("LEX: MINUS ('%s')\n", yytext); return MINUS; }
+#line 43 "lexer.l"
+{ LOG_TRACE("LEX: MINUS ('%s')\n", yytext); return MINUS; }
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 36 "lexer.l"
-{ printf("LEX: MUL\n"); return MUL; }
+#line 44 "lexer.l"
+{ LOG_TRACE("LEX: MUL\n"); return MUL; }
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 37 "lexer.l"
-{ printf("LEX: DIV\n"); return DIV; }
+#line 45 "lexer.l"
+{ LOG_TRACE("LEX: DIV\n"); return DIV; }
 	YY_BREAK
 case 22:
 YY_RULE_SETUP
-#line 38 "lexer.l"
-{ printf("LEX: MOD\n"); return MOD; }
+#line 46 "lexer.l"
+{ LOG_TRACE("LEX: MOD\n"); return MOD; }
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 40 "lexer.l"
-{ printf("LEX: SEMICOLON\n"); return SEMICOLON; }
+#line 48 "lexer.l"
+{ LOG_TRACE("LEX: SEMICOLON\n"); return SEMICOLON; }
 	YY_BREAK
 case 24:
 YY_RULE_SETUP
-#line 41 "lexer.l"
-{ printf("LEX: COMMA\n"); return COMMA; }
+#line 49 "lexer.l"
+{ LOG_TRACE("LEX: COMMA\n"); return COMMA; }
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 42 "lexer.l"
-{ printf("LEX: LBRACE\n"); return LBRACE; }
+#line 50 "lexer.l"
+{ LOG_TRACE("LEX: LBRACE\n"); return LBRACE; }
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
-#line 43 "lexer.l"
-{ printf("LEX: RBRACE\n"); return RBRACE; }
+#line 51 "lexer.l"
+{ LOG_TRACE("LEX: RBRACE\n"); return RBRACE; }
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
-#line 44 "lexer.l"
-{ printf("LEX: LPAREN\n"); return LPAREN; }
+#line 52 "lexer.l"
+{ LOG_TRACE("LEX: LPAREN\n"); return LPAREN; }
 	YY_BREAK
 case 28:
 YY_RULE_SETUP
-#line 45 "lexer.l"
-{ printf("LEX: RPAREN\n"); return RPAREN; }
+#line 53 "lexer.l"
+{ LOG_TRACE("LEX: RPAREN\n"); return RPAREN; }
 	YY_BREAK
 case 29:
 YY_RULE_SETUP
-#line 46 "lexer.l"
-{ printf("LEX: COLON\n"); return COLON; }
+#line 54 "lexer.l"
+{ LOG_TRACE("LEX: COLON\n"); return COLON; }
 	YY_BREAK
 case 30:
 YY_RULE_SETUP
-#line 48 "lexer.l"
+#line 56 "lexer.l"
 {
                            yylval.ival = atoi(yytext);
-                           printf("LEX: NUMBER ('%s')\n", yytext);
+                           LOG_TRACE("LEX: NUMBER ('%s')\n", yytext);
                            return NUMBER;
                        }
 	YY_BREAK
 case 31:
 YY_RULE_SETUP
-#line 54 "lexer.l"
+#line 62 "lexer.l"
 {
-                           yylval.sval = strdup(yytext);
-                           if (!yylval.sval) {
-                               fprintf(stderr, "CRITICAL ERROR: strdup failed for identifier '%s' in lexer. Exiting.\n", yytext);
-                               exit(1);
-                           }
-                           printf("LEX: IDENT ('%s')\n", yytext);
+                           yylval.sym = ctx->symbols.intern(std::string_view(yytext, yyleng));
+                           LOG_TRACE("LEX: IDENT ('%s')\n", yytext);
                            return IDENT;
                        }
 	YY_BREAK
 case 32:
 /* rule 32 can match eol */
 YY_RULE_SETUP
-#line 64 "lexer.l"
+#line 68 "lexer.l"
 { /* Ignore whitespace */ }
 	YY_BREAK
 case 33:
 YY_RULE_SETUP
-#line 66 "lexer.l"
+#line 70 "lexer.l"
 {
-                           printf("Lexical Error: Unknown character '%s' on line %d\n", yytext, yylineno);
+                           ctx->diagnostics.report("Lexical Error: Unknown character '%s' on line %d\n", yytext, yylineno);
                        }
 	YY_BREAK
 case 34:
 YY_RULE_SETUP
-#line 70 "lexer.l"
+#line 74 "lexer.l"
 ECHO;
 	YY_BREAK
-#line 996 "lex.yy.c"
+#line 1000 "lex.yy.c"
 case YY_STATE_EOF(INITIAL):
 	yyterminate();
 
@@ -2009,7 +2013,36 @@ void yyfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 70 "lexer.l"
+#line 74 "lexer.l"
+
+// --- CompilerContext glue ---
+// Callers hold the flex lock (see CompilerContext::parse) from flexBeginSource() until
+// flexEndSource(), since the scanner's buffer stack, yytext and yylineno are shared.
+
+void flexBeginSource(std::string_view source) {
+    yy_scan_bytes(source.data(), (int)source.size());
+    yylineno = 1;
+}
+
+// Scans `text` in place. The two bytes after it must be NUL (flex's end-of-buffer marks)
+// and the memory writable: flex NUL-terminates each token in the buffer while it runs.
+bool flexBeginBuffer(char* text, size_t size) {
+    if (size > (size_t)INT_MAX - 2) return false;
+    if (!yy_scan_buffer(text, size + 2)) return false;
+    yylineno = 1;
+    return true;
+}
 
+int flexLine() {
+    return yylineno;
+}
+
+void flexEndSource() {
+    if (!YY_CURRENT_BUFFER) return;
+    // Put back the byte under the terminator of the last token, so a caller's in-place
+    // buffer is left as it was.
+    *yy_c_buf_p = yy_hold_char;
+    yy_delete_buffer(YY_CURRENT_BUFFER);
+}
 
 
@@ -0,0 +1,419 @@
+// Command-line driver: compiles one file with a CompilerContext, prints each stage at
+// NORMAL verbosity and writes the program to output.asm. With --serve it instead stays
+// up answering compile requests on stdin (see serve.h); with --batch it compiles many
+// files in parallel (see batch.h). --write-ir=FILE also saves the AST and quads in a
+// binary IR file, and --read-ir takes such a file as input and runs only the stages
+// after the ones it holds (see ir_file.h). --write-3ac=FILE and --read-3ac do the same
+// with the 3AC listing as text (see parse3AC), so the backend can be run on
+// hand-written or generated quads. --stream compiles statement by statement in memory
+// that does not grow with the input (see streaming.h); it prints no AST or 3AC.
+// --dump-cfg[=dot] prints the control-flow graph of the quads (see cfg.h). -O runs the
+// optimizer on the quads before they are listed, dumped or translated (see optimizer.h).
+
+#include "batch.h"
+#include "cfg.h"
+#include "compiler_context.h"
+#include "ir_file.h"
+#include "optimizer.h"
+#include "packed_ast.h"
+#include "serve.h"
+#include "source_file.h"
+#include "streaming.h"
+#include "thread_pool.h"
+#include "x8086_generator.h"
+#include "verbosity.h"
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <vector>
+
+enum class CFGDump { None, Text, Dot };
+
+// --dump-cfg[=dot]: prints the graph of the quads to stdout, whatever the verbosity.
+static void dumpCFG(CFGDump mode, const Quad* quads, std::size_t count, const SymbolTable& symbols,
+                    const char* path) {
+    if (mode == CFGDump::None) return;
+    ControlFlowGraph cfg;
+    std::string error;
+    if (!buildCFG(quads, count, cfg, error)) {
+        fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return;
+    }
+    if (mode == CFGDump::Dot) printCFGDot(cfg, symbols, std::cout);
+    else printCFG(cfg, symbols, std::cout);
+}
+
+// -O and the single-pass flags. A listing that does not form a graph stays as it is.
+static void optimize(std::vector<Quad>& quads, const OptimizeOptions& options, const char* path) {
+    if (!options.any()) return;
+    OptimizeStats stats;
+    std::string error;
+    if (!optimizeQuads(quads, options, stats, error)) {
+        fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return;
+    }
+    LOG_NORMAL("Optimizer: %zu -> %zu quads\n", stats.quadsBefore, stats.quadsAfter);
+    if (options.constants)
+        LOG_NORMAL("  constants: %zu folded, %zu branches resolved, %zu blocks removed\n",
+                   stats.constants.folded, stats.constants.branchesResolved, stats.constants.blocksRemoved);
+    if (options.valueNumbering || options.globalValueNumbering)
+        LOG_NORMAL("  value numbering (%s): %zu computations reused, %zu redundant quads removed\n",
+                   options.globalValueNumbering ? "global" : "local", stats.valueNumbering.reused,
+                   stats.valueNumbering.removed);
+    if (options.copies)
+        LOG_NORMAL("  copies: %zu operands propagated, %zu temps coalesced, %zu dead temp quads, %zu temps removed\n",
+                   stats.copies.propagated, stats.copies.coalesced, stats.copies.deadTemps, stats.copies.tempsRemoved);
+    if (options.deadCode)
+        LOG_NORMAL("  dead code: %zu quads removed (%zu dead, %zu unreachable, %zu jumps and labels), %zu data words removed\n",
+                   stats.deadCode.quadsBefore - stats.deadCode.quadsAfter, stats.deadCode.deadDefinitions,
+                   stats.deadCode.unreachableQuads, stats.deadCode.jumpsAndLabels, stats.deadCode.dataWordsRemoved);
+}
+
+// --read-ir: lowers the file's AST unless it already holds quads, then generates code.
+static int runFromIR(const char* path, bool flatAST, const OptimizeOptions& optimizeOptions, CFGDump cfgDump) {
+    IRFile ir;
+    std::string error;
+    if (!ir.open(path, error)) {
+        fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return 1;
+    }
+    if (!ir.hasAST() && !ir.hasQuads()) {
+        LOG_NORMAL("IR file holds no program (possibly empty input).\n");
+        return 0;
+    }
+
+    SymbolTable symbols;
+    ir.loadSymbols(symbols);
+    if (ir.hasAST() && VERBOSITY_ENABLED(VERBOSITY_NORMAL)) {
+        printf("--- Abstract Syntax Tree ---\n");
+        printAST(ir.astView(), symbols, std::cout, flatAST);
+        printf("-----------------------------------\n\n");
+    }
+
+    // Quads from the file are used where they lie (unless optimized); only missing ones
+    // are generated.
+    std::vector<Quad> lowered;
+    const Quad* quads = ir.quads();
+    std::size_t quadCount = ir.quadCount();
+    if (!ir.hasQuads()) {
+        Diagnostics diagnostics;
+        diagnostics.setEcho(stderr);
+        TACState state;
+        state.diagnostics = &diagnostics;
+        generate3AC(ir.astView(), state, lowered);
+        quads = lowered.data();
+        quadCount = lowered.size();
+    }
+    if (optimizeOptions.any()) {
+        if (ir.hasQuads()) lowered.assign(quads, quads + quadCount);
+        optimize(lowered, optimizeOptions, path);
+        quads = lowered.data();
+        quadCount = lowered.size();
+    }
+    if (VERBOSITY_ENABLED(VERBOSITY_NORMAL)) {
+        printf("--- Three-Address Code ---\n");
+        print3AC(std::vector<Quad>(quads, quads + quadCount), symbols, std::cout);
+        printf("-------------------------------------------\n\n");
+    }
+    dumpCFG(cfgDump, quads, quadCount, symbols, path);
+
+    std::string outputAsmFile = "output.asm";
+    generate8086(quads, quadCount, symbols, outputAsmFile);
+    LOG_NORMAL("8086 Assembly saved to %s\n", outputAsmFile.c_str());
+    fflush(stdout);
+    return 0;
+}
+
+// --read-3ac: reads a 3AC listing and generates code from it.
+static int runFrom3AC(const char* path, const OptimizeOptions& optimizeOptions, CFGDump cfgDump) {
+    SourceFile source;
+    std::string error;
+    if (!source.open(path, error)) {
+        fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return 1;
+    }
+    SymbolTable symbols;
+    std::vector<Quad> quads;
+    if (!parse3AC(source.text(), symbols, quads, error)) {
+        fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return 1;
+    }
+    LOG_DEBUG("DEBUG: Main - Read %zu quads from %s.\n", quads.size(), path);
+    optimize(quads, optimizeOptions, path);
+    if (VERBOSITY_ENABLED(VERBOSITY_NORMAL)) {
+        print3AC(quads, symbols, std::cout);
+        printf("-------------------------------------------\n\n");
+    }
+    dumpCFG(cfgDump, quads.data(), quads.size(), symbols, path);
+
+    std::string outputAsmFile = "output.asm";
+    generate8086(quads, symbols, outputAsmFile);
+    LOG_NORMAL("8086 Assembly saved to %s\n", outputAsmFile.c_str());
+    fflush(stdout);
+    return 0;
+}
+
+// --stream: writes output.asm without holding the whole program (see compileStreaming).
+static int runStreaming(const char* path, SourceFile& source) {
+    CompilerContext ctx;
+    ctx.diagnostics.setEcho(stderr);
+    LOG_NORMAL("--- Compiling statement by statement ---\n");
+
+    std::string outputAsmFile = "output.asm";
+    StreamingStats stats;
+    std::string error;
+    if (compileStreaming(ctx, source, outputAsmFile, stats, error)) {
+        LOG_NORMAL("8086 Assembly saved to %s (%zu statements, %zu quads)\n", outputAsmFile.c_str(),
+                   stats.statements, stats.quads);
+    } else if (!error.empty()) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    } else {
+        LOG_NORMAL("Parsing failed in %s; nothing written.\n", path);
+    }
+    fflush(stdout);
+    return 0;
+}
+
+// The first argument that is one of `options` (an option ending in '=' matches any
+// value), or null if none is.
+static const char* findOption(int argc, char** argv, std::initializer_list<const char*> options) {
+    for (int i = 1; i < argc; ++i) {
+        for (const char* option : options) {
+            std::size_t length = strlen(option);
+            if (option[length - 1] == '=' ? strncmp(argv[i], option, length) == 0 : strcmp(argv[i], option) == 0)
+                return argv[i];
+        }
+    }
+    return nullptr;
+}
+
+static void printUsage(const char* program) {
+    fprintf(stderr, "Usage: %s [--flat-ast] [-q | --verbosity=0..3] [--scanner=builtin|flex|prelexed] [--lex-jobs=N] [--parser=bison|descent] [--share-exprs] [-O | --const-prop | --lvn | --gvn | --copy-prop | --dce] [--dump-cfg[=dot]] [--write-ir=FILE] [--write-3ac=FILE] <input_file>\n"
+                    "       %s [-q | --verbosity=0..3] --stream <input_file>\n"
+                    "       %s [--flat-ast] [-q | --verbosity=0..3] [-O | --const-prop | --lvn | --gvn | --copy-prop | --dce] [--dump-cfg[=dot]] --read-ir <ir_file>\n"
+                    "       %s [-q | --verbosity=0..3] [-O | --const-prop | --lvn | --gvn | --copy-prop | --dce] [--dump-cfg[=dot]] --read-3ac <3ac_file>\n"
+                    "       %s --batch [--jobs=N] [--out-dir=DIR] [--manifest=FILE] [--scanner=builtin|flex|prelexed] [--parser=bison|descent] [--share-exprs] [-O | --const-prop | --lvn | --gvn | --copy-prop | --dce] <input_file>...\n"
+                    "       %s --serve\n", program, program, program, program, program, program);
+    fflush(stderr);
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::string> inputs;
+    bool flatAST = false;  // --flat-ast: print each statement list as one node (linear output)
+    ScannerKind scannerKind = ScannerKind::Builtin;
+    ParserKind parserKind = ParserKind::Bison;
+    bool shareExpressions = false;  // --share-exprs: hash-cons pure expressions (see ExprFactory)
+    bool readIR = false;      // --read-ir: the input is an IR file, not source
+    std::string writeIRPath;  // --write-ir=FILE: save the AST and quads there
+    bool read3AC = false;     // --read-3ac: the input is a 3AC listing
+    std::string write3ACPath; // --write-3ac=FILE: save the 3AC listing there
+    bool stream = false;      // --stream: compile one statement at a time (see streaming.h)
+    CFGDump cfgDump = CFGDump::None;  // --dump-cfg[=dot]: print the control-flow graph
+    OptimizeOptions optimizeOptions;  // -O: every pass; --const-prop, --lvn, --gvn, --copy-prop, --dce: just those
+    bool serve = false;
+    bool batch = false;
+    int lexJobs = 0;  // --lex-jobs=N: threads lexing one input with --scanner=prelexed (0 = one per hardware thread)
+    BatchOptions batchOptions;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--flat-ast") == 0) flatAST = true;
+        else if (strcmp(argv[i], "-q") == 0 || strcmp(argv[i], "--quiet") == 0) verbosityLevel = VERBOSITY_QUIET;
+        else if (strncmp(argv[i], "--verbosity=", 12) == 0) {
+            if (!parseVerbosity(argv[i] + 12, verbosityLevel)) {
+                fprintf(stderr, "%s: --verbosity takes 0..3 or quiet, normal, debug, trace, not '%s'\n", argv[0], argv[i] + 12);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--scanner=flex") == 0) scannerKind = ScannerKind::Flex;
+        else if (strcmp(argv[i], "--scanner=builtin") == 0) scannerKind = ScannerKind::Builtin;
+        else if (strcmp(argv[i], "--scanner=prelexed") == 0) scannerKind = ScannerKind::Prelexed;
+        else if (strcmp(argv[i], "--parser=bison") == 0) parserKind = ParserKind::Bison;
+        else if (strcmp(argv[i], "--parser=descent") == 0) parserKind = ParserKind::Descent;
+        else if (strcmp(argv[i], "--share-exprs") == 0) shareExpressions = true;
+        else if (strncmp(argv[i], "--lex-jobs=", 11) == 0) {
+            char* end = nullptr;
+            long jobs = strtol(argv[i] + 11, &end, 10);
+            if (end == argv[i] + 11 || *end || jobs < 0 || jobs > INT_MAX) {
+                fprintf(stderr, "%s: --lex-jobs needs a positive number (or 0, one per hardware thread), not '%s'\n",
+                        argv[0], argv[i] + 11);
+                return 1;
+            }
+            lexJobs = static_cast<int>(jobs);
+        }
+        else if (strcmp(argv[i], "--read-ir") == 0) readIR = true;
+        else if (strncmp(argv[i], "--write-ir=", 11) == 0) writeIRPath = argv[i] + 11;
+        else if (strcmp(argv[i], "--read-3ac") == 0) read3AC = true;
+        else if (strncmp(argv[i], "--write-3ac=", 12) == 0) write3ACPath = argv[i] + 12;
+        else if (strcmp(argv[i], "--stream") == 0) stream = true;
+        else if (strcmp(argv[i], "-O") == 0) optimizeOptions = OptimizeOptions::all();
+        else if (strcmp(argv[i], "--const-prop") == 0) optimizeOptions.constants = true;
+        else if (strcmp(argv[i], "--lvn") == 0) optimizeOptions.valueNumbering = true;
+        else if (strcmp(argv[i], "--gvn") == 0) optimizeOptions.globalValueNumbering = true;
+        else if (strcmp(argv[i], "--copy-prop") == 0) optimizeOptions.copies = true;
+        else if (strcmp(argv[i], "--dce") == 0) optimizeOptions.deadCode = true;
+        else if (strcmp(argv[i], "--dump-cfg") == 0) cfgDump = CFGDump::Text;
+        else if (strcmp(argv[i], "--dump-cfg=dot") == 0) cfgDump = CFGDump::Dot;
+        else if (strcmp(argv[i], "--serve") == 0) serve = true;
+        else if (strcmp(argv[i], "--batch") == 0) batch = true;
+        else if (strncmp(argv[i], "--jobs=", 7) == 0) {
+            char* end = nullptr;
+            long jobs = strtol(argv[i] + 7, &end, 10);
+            if (end == argv[i] + 7 || *end || jobs <= 0 || jobs > INT_MAX) {
+                fprintf(stderr, "%s: --jobs needs a positive number, not '%s'\n", argv[0], argv[i] + 7);
+                return 1;
+            }
+            batchOptions.jobs = static_cast<unsigned>(jobs);
+        }
+        else if (strncmp(argv[i], "--out-dir=", 10) == 0) batchOptions.outputDir = argv[i] + 10;
+        else if (strncmp(argv[i], "--manifest=", 11) == 0) batchOptions.manifest = argv[i] + 11;
+        else if (argv[i][0] == '-' && argv[i][1]) {
+            fprintf(stderr, "%s: unknown option '%s'\n", argv[0], argv[i]);
+            printUsage(argv[0]);
+            return 1;
+        }
+        else inputs.push_back(argv[i]);
+    }
+
+    if (scannerKind != ScannerKind::Prelexed) {
+        if (const char* option = findOption(argc, argv, {"--lex-jobs="})) {
+            fprintf(stderr, "%s: %s only applies to --scanner=prelexed\n", argv[0], option);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (serve) {
+        // stdout carries the responses, so no stage may log there.
+        verbosityLevel = VERBOSITY_QUIET;
+        return runServer(stdin, stdout);
+    }
+
+    if (batch) {
+        // Workers run concurrently, so stage logging would interleave; report a summary instead.
+        verbosityLevel = VERBOSITY_QUIET;
+        batchOptions.inputs = inputs;
+        batchOptions.scanner = scannerKind;
+        batchOptions.parser = parserKind;
+        batchOptions.shareExpressions = shareExpressions;
+        batchOptions.optimize = optimizeOptions;
+        return runBatch(batchOptions);
+    }
+
+    LOG_DEBUG("DEBUG: Main - Program started.\n");
+
+    if (inputs.size() > 1) {
+        fprintf(stderr, "%s: one input file at a time (--batch compiles several)\n", argv[0]);
+        return 1;
+    }
+    if (inputs.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // --stream always scans with the builtin scanner, parses with the descent parser and
+    // translates each statement as it completes, so the options for the other stages
+    // would be silently ignored.
+    if (stream) {
+        if (const char* option = findOption(argc, argv, {"--flat-ast", "--scanner=", "--lex-jobs=", "--parser=",
+                "--share-exprs", "-O", "--const-prop", "--lvn", "--gvn", "--copy-prop", "--dce", "--dump-cfg",
+                "--dump-cfg=", "--write-ir=", "--write-3ac="})) {
+            fprintf(stderr, "%s: %s does not apply to --stream\n", argv[0], option);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // --read-ir and --read-3ac start after the front end and write only output.asm.
+    if (readIR || read3AC) {
+        if (const char* option = findOption(argc, argv, {"--scanner=", "--lex-jobs=", "--parser=", "--share-exprs",
+                "--write-ir=", "--write-3ac="})) {
+            fprintf(stderr, "%s: %s does not apply to %s\n", argv[0], option, readIR ? "--read-ir" : "--read-3ac");
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (read3AC && findOption(argc, argv, {"--flat-ast"})) {
+            fprintf(stderr, "%s: --flat-ast does not apply to --read-3ac\n", argv[0]);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    const char* inputPath = inputs[0].c_str();
+    if (readIR) return runFromIR(inputPath, flatAST, optimizeOptions, cfgDump);
+    if (read3AC) return runFrom3AC(inputPath, optimizeOptions, cfgDump);
+
+    SourceFile source;
+    std::string error;
+    if (!source.open(inputPath, error)) {
+        fprintf(stderr, "%s: %s\n", inputPath, error.c_str());
+        return 1;
+    }
+
+    if (stream) return runStreaming(inputPath, source);
+
+    CompilerContext ctx;
+    ctx.scannerKind = scannerKind;
+    ctx.parserKind = parserKind;
+    ctx.exprs.setSharing(shareExpressions);
+    ctx.lexWorkers = lexJobs > 0 ? static_cast<unsigned>(lexJobs) : defaultWorkerCount();
+    ctx.diagnostics.setEcho(stderr);
+
+    LOG_NORMAL("--- Parsing (Building AST) ---\n");
+
+    if (ctx.parse(source)) {
+        if (ctx.root != NULL) {
+            LOG_NORMAL("Parsing successful!\n-----------------------------------\n\n");
+            if (ctx.exprs.isSharing())
+                LOG_DEBUG("DEBUG: Main - %zu of %zu expression nodes allocated, the rest shared.\n",
+                          ctx.exprs.created(), ctx.exprs.requested());
+            if (VERBOSITY_ENABLED(VERBOSITY_NORMAL)) {
+                printf("--- Abstract Syntax Tree ---\n");
+                printAST(ctx.root, ctx.symbols, std::cout, flatAST);
+                printf("-----------------------------------\n\n");
+                printf("--- Three-Address Code ---\n");
+            }
+
+            std::vector<Quad> quads = ctx.generate3AC();
+            optimize(quads, optimizeOptions, inputPath);
+            if (VERBOSITY_ENABLED(VERBOSITY_NORMAL)) {
+                print3AC(quads, ctx.symbols, std::cout);
+                printf("-------------------------------------------\n\n");
+            }
+            dumpCFG(cfgDump, quads.data(), quads.size(), ctx.symbols, inputPath);
+
+            if (!write3ACPath.empty()) {
+                std::ofstream listing(write3ACPath);
+                print3AC(quads, ctx.symbols, listing);
+                if (!listing.flush()) fprintf(stderr, "%s: could not write the 3AC listing\n", write3ACPath.c_str());
+            }
+
+            if (!writeIRPath.empty()) {
+                PackedAST packed;
+                packAST(ctx.root, packed);
+                std::string error;
+                if (!writeIRFile(writeIRPath, ctx.symbols, &packed, &quads, error))
+                    fprintf(stderr, "%s: %s\n", writeIRPath.c_str(), error.c_str());
+                else
+                    LOG_NORMAL("IR saved to %s\n", writeIRPath.c_str());
+            }
+
+            // ✅ NEW: Generate 8086 Assembly
+            std::string outputAsmFile = "output.asm";
+            generate8086(quads, ctx.symbols, outputAsmFile);
+            LOG_NORMAL("8086 Assembly saved to %s\n", outputAsmFile.c_str());
+        } else {
+            LOG_NORMAL("Parsing succeeded, but AST root is NULL (possibly empty input).\n");
+        }
+    } else {
+        LOG_NORMAL("Parsing failed (yyparse returned non-zero).\n");
+    }
+
+    LOG_DEBUG("DEBUG: Main - Program finishing.\n");
+    fflush(stdout);
+    return 0;
+}
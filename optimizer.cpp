@@ -0,0 +1,49 @@
+#include "optimizer.h"
+#include "verbosity.h"
+#include <algorithm>
+
+// Numbers temps and labels 1, 2, ... in order of first appearance, so no number exceeds
+// the quad count (which --read-ir and --read-3ac check) and generate8086's tables indexed
+// by them shrink with the quads.
+static void renumberTempsAndLabels(std::vector<Quad>& quads) {
+    int maxTemp = 0;
+    int maxLabel = 0;
+    for (const Quad& q : quads) {
+        for (const Operand* operand : {&q.arg1, &q.arg2, &q.result}) {
+            if (operand->kind == OperandKind::Temp) maxTemp = std::max(maxTemp, operand->value);
+            else if (operand->kind == OperandKind::Label) maxLabel = std::max(maxLabel, operand->value);
+        }
+    }
+    std::vector<int> temps(static_cast<std::size_t>(maxTemp) + 1, 0);
+    std::vector<int> labels(static_cast<std::size_t>(maxLabel) + 1, 0);
+    int nextTemp = 0;
+    int nextLabel = 0;
+    for (Quad& q : quads) {
+        for (Operand* operand : {&q.arg1, &q.arg2, &q.result}) {
+            if (operand->kind == OperandKind::Temp) {
+                int& number = temps[operand->value];
+                if (number == 0) number = ++nextTemp;
+                operand->value = number;
+            } else if (operand->kind == OperandKind::Label) {
+                int& number = labels[operand->value];
+                if (number == 0) number = ++nextLabel;
+                operand->value = number;
+            }
+        }
+    }
+}
+
+bool optimizeQuads(std::vector<Quad>& quads, const OptimizeOptions& options, OptimizeStats& stats, std::string& error) {
+    stats = OptimizeStats();
+    stats.quadsBefore = quads.size();
+    if (options.constants && !propagateConstants(quads, stats.constants, error)) return false;
+    if ((options.valueNumbering || options.globalValueNumbering) &&
+        !numberValues(quads, options.globalValueNumbering, stats.valueNumbering, error))
+        return false;
+    if (options.copies) propagateCopies(quads, stats.copies);
+    if (options.deadCode && !eliminateDeadCode(quads, stats.deadCode, error)) return false;
+    if (options.any()) renumberTempsAndLabels(quads);
+    stats.quadsAfter = quads.size();
+    LOG_DEBUG("DEBUG: optimizeQuads - %zu -> %zu quads.\n", stats.quadsBefore, stats.quadsAfter);
+    return true;
+}
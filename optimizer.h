@@ -0,0 +1,53 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "const_prop.h"
+#include "copy_prop.h"
+#include "dead_code.h"
+#include "value_numbering.h"
+#include "three_address_code.h" // For Quad
+#include <string>
+#include <vector>
+
+// --- Quad optimizer ---
+// Runs the selected passes over the quads, between generate3AC and generate8086, in
+// this order: constants first, so the branches it resolves leave dead code behind; then
+// value numbering, then copies, which clears away the copies value numbering makes; dead
+// code last, which removes whatever the others left unread.
+// `compiler -O` turns on every pass; each also has its own flag.
+
+struct OptimizeOptions {
+    bool constants = false;             // --const-prop: constant folding and propagation (const_prop.h)
+    bool valueNumbering = false;        // --lvn: reuse values computed earlier in the block (value_numbering.h)
+    bool globalValueNumbering = false;  // --gvn: ... or in a dominating block
+    bool copies = false;                // --copy-prop: copy propagation and temp coalescing (copy_prop.h)
+    bool deadCode = false;              // --dce: dead code and dead store elimination (dead_code.h)
+
+    bool any() const { return constants || valueNumbering || globalValueNumbering || copies || deadCode; }
+    static OptimizeOptions all() {
+        OptimizeOptions options;
+        options.constants = true;
+        options.valueNumbering = true;
+        options.globalValueNumbering = true;
+        options.copies = true;
+        options.deadCode = true;
+        return options;
+    }
+};
+
+struct OptimizeStats {
+    std::size_t quadsBefore = 0;
+    std::size_t quadsAfter = 0;
+    ConstPropStats constants;
+    ValueNumberingStats valueNumbering;
+    CopyPropStats copies;
+    DeadCodeStats deadCode;
+};
+
+// Rewrites `quads` with the passes `options` selects, then renumbers the temps and labels
+// left densely from 1, so the result reads back like a fresh lowering (see --write-ir).
+// Fails only for quads that do not form a control-flow graph (a hand-written listing, see
+// buildCFG); `error` is then set and the quads are left as they were.
+bool optimizeQuads(std::vector<Quad>& quads, const OptimizeOptions& options, OptimizeStats& stats, std::string& error);
+
+#endif // OPTIMIZER_H
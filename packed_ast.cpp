@@ -0,0 +1,45 @@
+#include "packed_ast.h"
+
+void PackedAST::clear() {
+    nodes.clear();
+    extras.clear();
+    root = kNoPackedNode;
+}
+
+// Iterative post-order walk: a stmt_list spine is as deep as the program is long.
+void packAST(const ASTNode* root, PackedAST& out) {
+    out.clear();
+    if (!root) return;
+
+    struct Frame {
+        const ASTNode* node;
+        int next;                       // Child to visit next (0..3)
+        std::uint32_t children[4];      // Indices of the children packed so far
+    };
+    std::vector<Frame> stack;
+    stack.push_back({root, 0, {kNoPackedNode, kNoPackedNode, kNoPackedNode, kNoPackedNode}});
+
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        const ASTNode* node = frame.node;
+        const ASTNode* pending[4] = {node->left, node->right, node->third, node->fourth};
+        while (frame.next < 4 && !pending[frame.next]) ++frame.next;
+        if (frame.next < 4) {
+            const ASTNode* child = pending[frame.next++];
+            stack.push_back({child, 0, {kNoPackedNode, kNoPackedNode, kNoPackedNode, kNoPackedNode}});
+            continue;
+        }
+
+        PackedNode packed{node->kind, node->num, frame.children[0], frame.children[1]};
+        if (node->kind == NodeKind::If || node->kind == NodeKind::For) {
+            packed.payload = static_cast<std::int32_t>(out.extras.size());
+            out.extras.push_back({frame.children[2], frame.children[3]});
+        }
+        std::uint32_t index = static_cast<std::uint32_t>(out.nodes.size());
+        out.nodes.push_back(packed);
+
+        stack.pop_back();
+        if (stack.empty()) out.root = index;
+        else stack.back().children[stack.back().next - 1] = index;
+    }
+}
@@ -0,0 +1,130 @@
+#ifndef PACKED_AST_H
+#define PACKED_AST_H
+
+#include "ast.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// --- Packed AST ---
+// The same tree as the ASTNode graph, stored as one array in post-order: every node
+// comes after its children, so the statements of a stmt_list spine lie in source
+// order and the root is the last node. Children are 32-bit indices instead of
+// pointers. A node takes 16 bytes, against 40 for an ASTNode.
+//
+// Only If (else branch) and For (increment and body) have a third and fourth child.
+// Those two live in `extras`, and the node's payload holds the index of the pair.
+//
+// Build one with packAST(). Read it through PackedNodeRef, which gives the node-kind
+// semantics of ASTNode (left/right/third/fourth, num/sym/op). The lowering pass and
+// printAST accept either layout (see generate3AC and printAST overloads). They take a
+// PackedASTView, so the arrays can also live outside a PackedAST (in a mapped IR file,
+// see ir_file.h).
+
+constexpr std::uint32_t kNoPackedNode = UINT32_MAX;
+
+struct PackedNode {
+    NodeKind kind;
+    std::int32_t payload;  // num, sym or op as in ASTNode; index into extras for If and For
+    std::uint32_t left;
+    std::uint32_t right;
+};
+
+using PackedExtra = std::array<std::uint32_t, 2>;  // third and fourth of an If or For node
+
+// The arrays of a packed tree, wherever they are stored.
+struct PackedASTView {
+    const PackedNode* nodes = nullptr;
+    std::size_t nodeCount = 0;
+    const PackedExtra* extras = nullptr;
+    std::size_t extraCount = 0;
+    std::uint32_t root = kNoPackedNode;
+};
+
+struct PackedAST {
+    std::vector<PackedNode> nodes;
+    std::vector<PackedExtra> extras;
+    std::uint32_t root = kNoPackedNode;
+
+    bool empty() const { return root == kNoPackedNode; }
+    void clear();
+    PackedASTView view() const { return {nodes.data(), nodes.size(), extras.data(), extras.size(), root}; }
+};
+
+// Stores the tree under `root` in `out` in post-order, replacing what `out` held.
+// A hash-consed DAG (see ExprFactory) is unshared on the way: each use of a shared
+// node gets its own copy, so the result is a tree.
+void packAST(const ASTNode* root, PackedAST& out);
+
+// Read-only handle on one packed node, mirroring the fields of ASTNode.
+class PackedNodeRef {
+public:
+    PackedNodeRef() = default;
+    PackedNodeRef(const PackedNode* nodes, const PackedExtra* extras, std::uint32_t index)
+        : nodes(nodes), extras(extras), id(index) {}
+
+    explicit operator bool() const { return id != kNoPackedNode; }
+    std::uint32_t index() const { return id; }
+
+    NodeKind kind() const { return node().kind; }
+    int num() const { return node().payload; }
+    Symbol sym() const { return static_cast<Symbol>(node().payload); }
+    OpKind op() const { return static_cast<OpKind>(node().payload); }
+
+    PackedNodeRef left() const { return child(node().left); }
+    PackedNodeRef right() const { return child(node().right); }
+    PackedNodeRef third() const { return child(hasExtras() ? extras[node().payload][0] : kNoPackedNode); }
+    PackedNodeRef fourth() const { return child(hasExtras() ? extras[node().payload][1] : kNoPackedNode); }
+
+private:
+    const PackedNode& node() const { return nodes[id]; }
+    bool hasExtras() const { return node().kind == NodeKind::If || node().kind == NodeKind::For; }
+    PackedNodeRef child(std::uint32_t index) const { return {nodes, extras, index}; }
+
+    const PackedNode* nodes = nullptr;
+    const PackedExtra* extras = nullptr;
+    std::uint32_t id = kNoPackedNode;
+};
+
+// The same interface over an ASTNode, so passes can be written once for both layouts.
+class TreeNodeRef {
+public:
+    TreeNodeRef(ASTNode* node = nullptr) : ptr(node) {}
+
+    explicit operator bool() const { return ptr != nullptr; }
+
+    NodeKind kind() const { return ptr->kind; }
+    int num() const { return ptr->num; }
+    Symbol sym() const { return ptr->sym; }
+    OpKind op() const { return ptr->op; }
+
+    TreeNodeRef left() const { return ptr->left; }
+    TreeNodeRef right() const { return ptr->right; }
+    TreeNodeRef third() const { return ptr->third; }
+    TreeNodeRef fourth() const { return ptr->fourth; }
+
+private:
+    ASTNode* ptr;
+};
+
+inline PackedNodeRef packedRoot(const PackedASTView& ast) { return {ast.nodes, ast.extras, ast.root}; }
+
+// collectStatements() for either handle type.
+template <typename Node>
+void collectStatementsOf(Node node, std::vector<Node>& out) {
+    std::size_t first = out.size();
+    while (node && node.kind() == NodeKind::StmtList) {
+        if (node.right()) out.push_back(node.right());
+        node = node.left();
+    }
+    if (node) out.push_back(node);
+    std::reverse(out.begin() + first, out.end());
+}
+
+// printAST() on the packed layout; prints exactly what printAST prints for the tree.
+void printAST(const PackedASTView& ast, const SymbolTable& symbols, std::ostream& out = std::cout,
+              bool flattenLists = false);
+
+#endif // PACKED_AST_H
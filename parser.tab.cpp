@@ -55,7 +55,7 @@
 #define YYSKELETON_NAME "yacc.c"
 
 /* Pure parsers.  */
-#define YYPURE 0
+#define YYPURE 2
 
 /* Push parsers.  */
 #define YYPUSH 0
@@ -66,41 +66,6 @@
 
 
 
-/* First part of user prologue.  */
-#line 1 "parser.y"
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <vector>
-#include <string>
-
-#include "ast.h"
-#include "three_address_code.h"
-#include "x8086_generator.h"  
-
-
-extern int yylex();
-extern void yyerror(const char *s);
-extern FILE* yyin;
-extern int yylineno;
-extern const char* tokenToString(int token);
-
-extern ASTNode* createNumNode(int val);
-extern ASTNode* createIdNode(char* name);
-extern ASTNode* createOpNode(const std::string& op, ASTNode* l, ASTNode* r);
-extern ASTNode* createAssignNode(char* name, ASTNode* expr);
-extern ASTNode* createIfNode(ASTNode* cond, ASTNode* thenStmt, ASTNode* elseStmt);
-extern ASTNode* createWhileNode(ASTNode* cond, ASTNode* body);
-extern ASTNode* createForNode(ASTNode* init, ASTNode* cond, ASTNode* inc, ASTNode* body);
-extern ASTNode* createSwitchNode(ASTNode* expr, ASTNode* cases);
-extern ASTNode* createCaseNode(int val, ASTNode* body, ASTNode* next);
-extern ASTNode* createNode(const std::string& type, ASTNode* left, ASTNode* right);
-
-ASTNode* root = nullptr;
-
-
-#line 104 "parser.tab.c"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -174,6 +139,15 @@ typedef enum yysymbol_kind_t yysymbol_kind_t;
 
 
 
+/* Unqualified %code blocks.  */
+#line 6 "parser.y"
+
+#include "compiler_context.h"
+
+int yylex(YYSTYPE* value, CompilerContext* ctx);
+void yyerror(CompilerContext* ctx, const char* s);
+
+#line 151 "parser.tab.c"
 
 #ifdef short
 # undef short
@@ -557,10 +531,10 @@ static const yytype_int8 yytranslate[] =
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int8 yyrline[] =
 {
-       0,    66,    66,    70,    71,    75,    76,    77,    78,    79,
-      80,    82,    84,    85,    89,    90,    94,    95,    96,   101,
-     102,   103,   104,   105,   106,   107,   108,   109,   110,   111,
-     112,   113,   114,   115,   116,   117,   118
+       0,    49,    49,    53,    54,    58,    59,    60,    61,    62,
+      63,    65,    67,    68,    72,    73,    77,    78,    79,    84,
+      85,    86,    87,    88,    89,    90,    91,    92,    93,    94,
+      95,    96,    97,    98,    99,   100,   101
 };
 #endif
 
@@ -764,7 +738,7 @@ enum { YYENOMEM = -2 };
       }                                                           \
     else                                                          \
       {                                                           \
-        yyerror (YY_("syntax error: cannot back up")); \
+        yyerror (ctx, YY_("syntax error: cannot back up")); \
         YYERROR;                                                  \
       }                                                           \
   while (0)
@@ -797,7 +771,7 @@ do {                                                                      \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Kind, Value); \
+                  Kind, Value, ctx); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
@@ -809,10 +783,11 @@ do {                                                                      \
 
 static void
 yy_symbol_value_print (FILE *yyo,
-                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, CompilerContext* ctx)
 {
   FILE *yyoutput = yyo;
   YY_USE (yyoutput);
+  YY_USE (ctx);
   if (!yyvaluep)
     return;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
@@ -827,12 +802,12 @@ yy_symbol_value_print (FILE *yyo,
 
 static void
 yy_symbol_print (FILE *yyo,
-                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, CompilerContext* ctx)
 {
   YYFPRINTF (yyo, "%s %s (",
              yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  yy_symbol_value_print (yyo, yykind, yyvaluep, ctx);
   YYFPRINTF (yyo, ")");
 }
 
@@ -866,7 +841,7 @@ do {                                                            \
 
 static void
 yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
-                 int yyrule)
+                 int yyrule, CompilerContext* ctx)
 {
   int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
@@ -879,7 +854,7 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
                        YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
-                       &yyvsp[(yyi + 1) - (yynrhs)]);
+                       &yyvsp[(yyi + 1) - (yynrhs)], ctx);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -887,7 +862,7 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
 # define YY_REDUCE_PRINT(Rule)          \
 do {                                    \
   if (yydebug)                          \
-    yy_reduce_print (yyssp, yyvsp, Rule); \
+    yy_reduce_print (yyssp, yyvsp, Rule, ctx); \
 } while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
@@ -928,9 +903,10 @@ int yydebug;
 
 static void
 yydestruct (const char *yymsg,
-            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, CompilerContext* ctx)
 {
   YY_USE (yyvaluep);
+  YY_USE (ctx);
   if (!yymsg)
     yymsg = "Deleting";
   YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
@@ -941,13 +917,6 @@ yydestruct (const char *yymsg,
 }
 
 
-/* Lookahead token kind.  */
-int yychar;
-
-/* The semantic value of the lookahead symbol.  */
-YYSTYPE yylval;
-/* Number of syntax errors so far.  */
-int yynerrs;
 
 
 
@@ -957,8 +926,21 @@ int yynerrs;
 `----------*/
 
 int
-yyparse (void)
+yyparse (CompilerContext* ctx)
 {
+/* Lookahead token kind.  */
+int yychar;
+
+
+/* The semantic value of the lookahead symbol.  */
+/* Default value used for initialization, for pacifying older GCCs
+   or non-GCC compilers.  */
+YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
+YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
+
+    /* Number of syntax errors so far.  */
+    int yynerrs = 0;
+
     yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
     int yyerrstatus = 0;
@@ -1111,7 +1093,7 @@ yybackup:
   if (yychar == YYEMPTY)
     {
       YYDPRINTF ((stderr, "Reading a token\n"));
-      yychar = yylex ();
+      yychar = yylex (&yylval, ctx);
     }
 
   if (yychar <= YYEOF)
@@ -1199,217 +1181,217 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* program: stmt_list  */
-#line 66 "parser.y"
-                                               { root = (yyvsp[0].node); }
-#line 1205 "parser.tab.c"
+#line 49 "parser.y"
+                                               { ctx->root = (yyvsp[0].node); }
+#line 1187 "parser.tab.c"
     break;
 
   case 3: /* stmt_list: stmt  */
-#line 70 "parser.y"
+#line 53 "parser.y"
                                                { (yyval.node) = (yyvsp[0].node); }
-#line 1211 "parser.tab.c"
+#line 1193 "parser.tab.c"
     break;
 
   case 4: /* stmt_list: stmt_list stmt  */
-#line 71 "parser.y"
-                                               { (yyval.node) = createNode("stmt_list", (yyvsp[-1].node), (yyvsp[0].node)); }
-#line 1217 "parser.tab.c"
+#line 54 "parser.y"
+                                               { (yyval.node) = createNode(ctx->astArena, NodeKind::StmtList, (yyvsp[-1].node), (yyvsp[0].node)); }
+#line 1199 "parser.tab.c"
     break;
 
   case 5: /* stmt: IDENT ASSIGN expr SEMICOLON  */
-#line 75 "parser.y"
-                                               { (yyval.node) = createAssignNode((yyvsp[-3].sval), (yyvsp[-1].node)); }
-#line 1223 "parser.tab.c"
+#line 58 "parser.y"
+                                               { (yyval.node) = createAssignNode(ctx->astArena, (yyvsp[-3].sym), (yyvsp[-1].node)); }
+#line 1205 "parser.tab.c"
     break;
 
   case 6: /* stmt: expr SEMICOLON  */
-#line 76 "parser.y"
+#line 59 "parser.y"
                                                { (yyval.node) = (yyvsp[-1].node); }
-#line 1229 "parser.tab.c"
+#line 1211 "parser.tab.c"
     break;
 
   case 7: /* stmt: IF LPAREN expr RPAREN stmt  */
-#line 77 "parser.y"
-                                               { (yyval.node) = createIfNode((yyvsp[-2].node), (yyvsp[0].node), nullptr); }
-#line 1235 "parser.tab.c"
+#line 60 "parser.y"
+                                               { (yyval.node) = createIfNode(ctx->astArena, (yyvsp[-2].node), (yyvsp[0].node), nullptr); }
+#line 1217 "parser.tab.c"
     break;
 
   case 8: /* stmt: IF LPAREN expr RPAREN stmt ELSE stmt  */
-#line 78 "parser.y"
-                                               { (yyval.node) = createIfNode((yyvsp[-4].node), (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1241 "parser.tab.c"
+#line 61 "parser.y"
+                                               { (yyval.node) = createIfNode(ctx->astArena, (yyvsp[-4].node), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1223 "parser.tab.c"
     break;
 
   case 9: /* stmt: WHILE LPAREN expr RPAREN stmt  */
-#line 79 "parser.y"
-                                               { (yyval.node) = createWhileNode((yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1247 "parser.tab.c"
+#line 62 "parser.y"
+                                               { (yyval.node) = createWhileNode(ctx->astArena, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1229 "parser.tab.c"
     break;
 
   case 10: /* stmt: FOR LPAREN opt_expr SEMICOLON opt_expr SEMICOLON opt_expr RPAREN stmt  */
-#line 81 "parser.y"
-                                               { (yyval.node) = createForNode((yyvsp[-6].node), (yyvsp[-4].node), (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1253 "parser.tab.c"
+#line 64 "parser.y"
+                                               { (yyval.node) = createForNode(ctx->astArena, (yyvsp[-6].node), (yyvsp[-4].node), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1235 "parser.tab.c"
     break;
 
   case 11: /* stmt: SWITCH LPAREN expr RPAREN LBRACE case_list RBRACE  */
-#line 83 "parser.y"
-                                               { (yyval.node) = createSwitchNode((yyvsp[-4].node), (yyvsp[-1].node)); }
-#line 1259 "parser.tab.c"
+#line 66 "parser.y"
+                                               { (yyval.node) = createSwitchNode(ctx->astArena, (yyvsp[-4].node), (yyvsp[-1].node)); }
+#line 1241 "parser.tab.c"
     break;
 
   case 12: /* stmt: BREAK SEMICOLON  */
-#line 84 "parser.y"
-                                               { (yyval.node) = createNode("break", nullptr, nullptr); }
-#line 1265 "parser.tab.c"
+#line 67 "parser.y"
+                                               { (yyval.node) = createNode(ctx->astArena, NodeKind::Break, nullptr, nullptr); }
+#line 1247 "parser.tab.c"
     break;
 
   case 13: /* stmt: LBRACE stmt_list RBRACE  */
-#line 85 "parser.y"
+#line 68 "parser.y"
                                                { (yyval.node) = (yyvsp[-1].node); }
-#line 1271 "parser.tab.c"
+#line 1253 "parser.tab.c"
     break;
 
   case 14: /* opt_expr: expr  */
-#line 89 "parser.y"
+#line 72 "parser.y"
                                                { (yyval.node) = (yyvsp[0].node); }
-#line 1277 "parser.tab.c"
+#line 1259 "parser.tab.c"
     break;
 
   case 15: /* opt_expr: %empty  */
-#line 90 "parser.y"
+#line 73 "parser.y"
                                                { (yyval.node) = nullptr; }
-#line 1283 "parser.tab.c"
+#line 1265 "parser.tab.c"
     break;
 
   case 16: /* case_list: %empty  */
-#line 94 "parser.y"
+#line 77 "parser.y"
                                                  { (yyval.node) = nullptr; }
-#line 1289 "parser.tab.c"
+#line 1271 "parser.tab.c"
     break;
 
   case 17: /* case_list: case_list CASE NUMBER COLON stmt_list  */
-#line 95 "parser.y"
-                                                 { (yyval.node) = createNode("case_list_entry", (yyvsp[-4].node), createCaseNode((yyvsp[-2].ival), (yyvsp[0].node), nullptr)); }
-#line 1295 "parser.tab.c"
+#line 78 "parser.y"
+                                                 { (yyval.node) = createNode(ctx->astArena, NodeKind::CaseListEntry, (yyvsp[-4].node), createCaseNode(ctx->astArena, (yyvsp[-2].ival), (yyvsp[0].node), nullptr)); }
+#line 1277 "parser.tab.c"
     break;
 
   case 18: /* case_list: case_list DEFAULT COLON stmt_list  */
-#line 96 "parser.y"
-                                                 { (yyval.node) = createNode("case_list_entry", (yyvsp[-3].node), createNode("default_case", (yyvsp[0].node), nullptr)); }
-#line 1301 "parser.tab.c"
+#line 79 "parser.y"
+                                                 { (yyval.node) = createNode(ctx->astArena, NodeKind::CaseListEntry, (yyvsp[-3].node), createNode(ctx->astArena, NodeKind::DefaultCase, (yyvsp[0].node), nullptr)); }
+#line 1283 "parser.tab.c"
     break;
 
   case 19: /* expr: expr PLUS expr  */
-#line 101 "parser.y"
-                                               { (yyval.node) = createOpNode("+", (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1307 "parser.tab.c"
+#line 84 "parser.y"
+                                               { (yyval.node) = ctx->exprs.op(OpKind::Add, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1289 "parser.tab.c"
     break;
 
   case 20: /* expr: expr MINUS expr  */
-#line 102 "parser.y"
-                                               { (yyval.node) = createOpNode("-", (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1313 "parser.tab.c"
+#line 85 "parser.y"
+                                               { (yyval.node) = ctx->exprs.op(OpKind::Sub, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1295 "parser.tab.c"
     break;
 
   case 21: /* expr: expr MUL expr  */
-#line 103 "parser.y"
-                                               { (yyval.node) = createOpNode("*", (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1319 "parser.tab.c"
+#line 86 "parser.y"
+                                               { (yyval.node) = ctx->exprs.op(OpKind::Mul, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1301 "parser.tab.c"
     break;
 
   case 22: /* expr: expr DIV expr  */
-#line 104 "parser.y"
-                                               { (yyval.node) = createOpNode("/", (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1325 "parser.tab.c"
+#line 87 "parser.y"
+                                               { (yyval.node) = ctx->exprs.op(OpKind::Div, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1307 "parser.tab.c"
     break;
 
   case 23: /* expr: expr MOD expr  */
-#line 105 "parser.y"
-                                               { (yyval.node) = createOpNode("%", (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1331 "parser.tab.c"
+#line 88 "parser.y"
+                                               { (yyval.node) = ctx->exprs.op(OpKind::Mod, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1313 "parser.tab.c"
     break;
 
   case 24: /* expr: expr LT expr  */
-#line 106 "parser.y"
-                                               { (yyval.node) = createOpNode("<", (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1337 "parser.tab.c"
+#line 89 "parser.y"
+                                               { (yyval.node) = ctx->exprs.op(OpKind::Lt, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1319 "parser.tab.c"
     break;
 
   case 25: /* expr: expr GT expr  */
-#line 107 "parser.y"
-                                               { (yyval.node) = createOpNode(">", (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1343 "parser.tab.c"
+#line 90 "parser.y"
+                                               { (yyval.node) = ctx->exprs.op(OpKind::Gt, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1325 "parser.tab.c"
     break;
 
   case 26: /* expr: expr LE expr  */
-#line 108 "parser.y"
-                                               { (yyval.node) = createOpNode("<=", (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1349 "parser.tab.c"
+#line 91 "parser.y"
+                                               { (yyval.node) = ctx->exprs.op(OpKind::Le, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1331 "parser.tab.c"
     break;
 
   case 27: /* expr: expr GE expr  */
-#line 109 "parser.y"
-                                               { (yyval.node) = createOpNode(">=", (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1355 "parser.tab.c"
+#line 92 "parser.y"
+                                               { (yyval.node) = ctx->exprs.op(OpKind::Ge, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1337 "parser.tab.c"
     break;
 
   case 28: /* expr: expr EQ expr  */
-#line 110 "parser.y"
-                                               { (yyval.node) = createOpNode("==", (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1361 "parser.tab.c"
+#line 93 "parser.y"
+                                               { (yyval.node) = ctx->exprs.op(OpKind::Eq, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1343 "parser.tab.c"
     break;
 
   case 29: /* expr: expr NE expr  */
-#line 111 "parser.y"
-                                               { (yyval.node) = createOpNode("!=", (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1367 "parser.tab.c"
+#line 94 "parser.y"
+                                               { (yyval.node) = ctx->exprs.op(OpKind::Ne, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1349 "parser.tab.c"
     break;
 
   case 30: /* expr: LPAREN expr RPAREN  */
-#line 112 "parser.y"
+#line 95 "parser.y"
                                                { (yyval.node) = (yyvsp[-1].node); }
-#line 1373 "parser.tab.c"
+#line 1355 "parser.tab.c"
     break;
 
   case 31: /* expr: NUMBER  */
-#line 113 "parser.y"
-                                               { (yyval.node) = createNumNode((yyvsp[0].ival)); }
-#line 1379 "parser.tab.c"
+#line 96 "parser.y"
+                                               { (yyval.node) = ctx->exprs.num((yyvsp[0].ival)); }
+#line 1361 "parser.tab.c"
     break;
 
   case 32: /* expr: IDENT  */
-#line 114 "parser.y"
-                                               { (yyval.node) = createIdNode((yyvsp[0].sval)); }
-#line 1385 "parser.tab.c"
+#line 97 "parser.y"
+                                               { (yyval.node) = ctx->exprs.id((yyvsp[0].sym)); }
+#line 1367 "parser.tab.c"
     break;
 
   case 33: /* expr: IDENT INCR  */
-#line 115 "parser.y"
-                                               { (yyval.node) = createOpNode("++_post", createIdNode((yyvsp[-1].sval)), nullptr); }
-#line 1391 "parser.tab.c"
+#line 98 "parser.y"
+                                               { (yyval.node) = ctx->exprs.op(OpKind::PostInc, ctx->exprs.id((yyvsp[-1].sym)), nullptr); }
+#line 1373 "parser.tab.c"
     break;
 
   case 34: /* expr: IDENT DECR  */
-#line 116 "parser.y"
-                                               { (yyval.node) = createOpNode("--_post", createIdNode((yyvsp[-1].sval)), nullptr); }
-#line 1397 "parser.tab.c"
+#line 99 "parser.y"
+                                               { (yyval.node) = ctx->exprs.op(OpKind::PostDec, ctx->exprs.id((yyvsp[-1].sym)), nullptr); }
+#line 1379 "parser.tab.c"
     break;
 
   case 35: /* expr: INCR IDENT  */
-#line 117 "parser.y"
-                                               { (yyval.node) = createOpNode("++_pre", createIdNode((yyvsp[0].sval)), nullptr); }
-#line 1403 "parser.tab.c"
+#line 100 "parser.y"
+                                               { (yyval.node) = ctx->exprs.op(OpKind::PreInc, ctx->exprs.id((yyvsp[0].sym)), nullptr); }
+#line 1385 "parser.tab.c"
     break;
 
   case 36: /* expr: DECR IDENT  */
-#line 118 "parser.y"
-                                               { (yyval.node) = createOpNode("--_pre", createIdNode((yyvsp[0].sval)), nullptr); }
-#line 1409 "parser.tab.c"
+#line 101 "parser.y"
+                                               { (yyval.node) = ctx->exprs.op(OpKind::PreDec, ctx->exprs.id((yyvsp[0].sym)), nullptr); }
+#line 1391 "parser.tab.c"
     break;
 
 
-#line 1413 "parser.tab.c"
+#line 1395 "parser.tab.c"
 
       default: break;
     }
@@ -1456,7 +1438,7 @@ yyerrlab:
   if (!yyerrstatus)
     {
       ++yynerrs;
-      yyerror (YY_("syntax error"));
+      yyerror (ctx, YY_("syntax error"));
     }
 
   if (yyerrstatus == 3)
@@ -1473,7 +1455,7 @@ yyerrlab:
       else
         {
           yydestruct ("Error: discarding",
-                      yytoken, &yylval);
+                      yytoken, &yylval, ctx);
           yychar = YYEMPTY;
         }
     }
@@ -1529,7 +1511,7 @@ yyerrlab1:
 
 
       yydestruct ("Error: popping",
-                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, ctx);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -1567,7 +1549,7 @@ yyabortlab:
 | yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
 `-----------------------------------------------------------*/
 yyexhaustedlab:
-  yyerror (YY_("memory exhausted"));
+  yyerror (ctx, YY_("memory exhausted"));
   yyresult = 2;
   goto yyreturnlab;
 
@@ -1582,7 +1564,7 @@ yyreturnlab:
          user semantic actions for why this is necessary.  */
       yytoken = YYTRANSLATE (yychar);
       yydestruct ("Cleanup: discarding lookahead",
-                  yytoken, &yylval);
+                  yytoken, &yylval, ctx);
     }
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
@@ -1591,7 +1573,7 @@ yyreturnlab:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, ctx);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
@@ -1602,81 +1584,5 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 121 "parser.y"
-
-
-void yyerror(const char *s) {
-    fprintf(stderr, "Parse error: %s at line %d\n", s, yylineno);
-    fflush(stderr);
-}
-void print3AC(const std::vector<Quad>& quads) {
-    std::cout << "--- Three-Address Code ---" << std::endl;
-    std::cout << "DEBUG: print3AC - Entered. Number of quads: " << quads.size() << std::endl;
-
-    for (const auto& q : quads) {
-        if (q.op == "=") {
-            std::cout << q.result << " = " << q.arg1 << std::endl;
-        } else if (q.op == "label") {
-            std::cout << q.result << ":" << std::endl;
-        } else if (q.op == "goto") {
-            std::cout << "goto " << q.result << std::endl;
-        } else if (q.op == "ifFalse") {
-            std::cout << "ifFalse " << q.arg1 << " goto " << q.result << std::endl;
-        } else if (q.op == "if") {
-            std::cout << "if " << q.arg1 << " goto " << q.result << std::endl;
-        } else {
-            std::cout << q.result << " = " << q.arg1 << " " << q.op << " " << q.arg2 << std::endl;
-        }
-    }
-
-    std::cout << "DEBUG: print3AC - Exited normally after processing " << quads.size() << " quads." << std::endl;
-    std::cout << "-----------------------------------" << std::endl;
-}
-
-int main(int argc, char **argv) {
-    printf("DEBUG: Main - Program started.\n"); fflush(stdout);
-
-    if (argc <= 1) {
-        fprintf(stderr, "Usage: %s <input_file>\n", argv[0]);
-        fflush(stderr);
-        return 1;
-    }
-
-    yyin = fopen(argv[1], "r");
-    if (!yyin) {
-        perror(argv[1]);
-        return 1;
-    }
-
-    yylineno = 1;
-
-    printf("--- Parsing (Building AST) ---\n"); fflush(stdout);
-
-    if (yyparse() == 0) {
-        if (root != NULL) {
-            printf("Parsing successful!\n-----------------------------------\n\n");
-            printf("--- Abstract Syntax Tree ---\n");
-            printAST(root);
-            printf("-----------------------------------\n\n");
-
-            printf("--- Three-Address Code ---\n");
-            std::vector<Quad> quads = generate3AC(root);
-            print3AC(quads);
-            printf("-------------------------------------------\n\n");
-
-            // ✅ NEW: Generate 8086 Assembly
-            std::string outputAsmFile = "output.asm";
-            generate8086(quads, outputAsmFile);
-            printf("8086 Assembly saved to %s\n", outputAsmFile.c_str());
-        } else {
-            printf("Parsing succeeded, but AST root is NULL (possibly empty input).\n");
-        }
-    } else {
-        printf("Parsing failed (yyparse returned non-zero).\n");
-    }
-
-    if (yyin) fclose(yyin);
-    printf("DEBUG: Main - Program finishing.\n"); fflush(stdout);
-    return 0;
-}
+#line 104 "parser.y"
 
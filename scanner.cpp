@@ -0,0 +1,517 @@
+#include "scanner.h"
+#include "thread_pool.h"
+#include "verbosity.h"
+#include <algorithm>
+#include <climits>  // For LONG_MAX
+#include <cstdint>
+#include <cstring>  // For memcmp
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCANNER_X86 1
+#else
+#define SCANNER_X86 0
+#endif
+
+namespace {
+
+// --- Keywords ---
+// (first character * 4 + length) & 15 is collision-free for the eight keywords, so one
+// table probe and one compare decide whether an identifier is a keyword.
+
+struct Keyword {
+    const char* text;
+    std::size_t length;
+    int token;
+};
+
+constexpr Keyword kKeywords[] = {
+    {"if", 2, IF},
+    {"else", 4, ELSE},
+    {"while", 5, WHILE},
+    {"for", 3, FOR},
+    {"switch", 6, SWITCH},
+    {"case", 4, CASE},
+    {"default", 7, DEFAULT},
+    {"break", 5, BREAK},
+};
+
+constexpr unsigned keywordHash(char first, std::size_t length) {
+    return (static_cast<unsigned char>(first) * 4u + static_cast<unsigned>(length)) & 15u;
+}
+
+struct KeywordTable {
+    signed char slot[16];  // Index into kKeywords, or -1
+};
+
+constexpr KeywordTable buildKeywordTable() {
+    KeywordTable table{};
+    for (auto& s : table.slot) s = -1;
+    for (int i = 0; i < 8; ++i) table.slot[keywordHash(kKeywords[i].text[0], kKeywords[i].length)] = i;
+    return table;
+}
+
+constexpr KeywordTable kKeywordTable = buildKeywordTable();
+
+constexpr bool keywordHashIsPerfect() {
+    int used = 0;
+    for (signed char s : kKeywordTable.slot) used += s >= 0;
+    return used == 8;
+}
+static_assert(keywordHashIsPerfect(), "keywordHash maps two keywords to one slot");
+
+inline const Keyword* findKeyword(const char* text, std::size_t length) {
+    if (length < 2 || length > 7) return nullptr;
+    int index = kKeywordTable.slot[keywordHash(text[0], length)];
+    if (index < 0) return nullptr;
+    const Keyword& keyword = kKeywords[index];
+    return keyword.length == length && memcmp(keyword.text, text, length) == 0 ? &keyword : nullptr;
+}
+
+// --- Character classes ---
+
+inline bool isIdentStart(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+inline bool isIdentChar(char c) { return isIdentStart(c) || isDigit(c); }
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n'; }
+
+// --- Run kernels ---
+// Each returns the first position in [p, end) outside the run. The vector versions only
+// load whole blocks that lie inside the buffer and finish the tail byte by byte, so they
+// never read past `end`.
+
+template <SimdLevel L>
+struct Kernels {
+    static const char* skipSpace(const char* p, const char* end, int& lines) {
+        for (; p < end && isSpace(*p); ++p) lines += *p == '\n';
+        return p;
+    }
+    static const char* skipIdent(const char* p, const char* end) {
+        while (p < end && isIdentChar(*p)) ++p;
+        return p;
+    }
+    static const char* skipDigits(const char* p, const char* end) {
+        while (p < end && isDigit(*p)) ++p;
+        return p;
+    }
+};
+
+#if SCANNER_X86
+
+// Bytes b with lo <= b <= lo + span (unsigned), as a byte mask.
+inline __m128i inRange(__m128i bytes, char lo, char span) {
+    __m128i offset = _mm_sub_epi8(bytes, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(span)), offset);
+}
+
+inline unsigned identMask(__m128i bytes) {
+    __m128i letter = inRange(_mm_or_si128(bytes, _mm_set1_epi8(0x20)), 'a', 25);
+    __m128i digit = inRange(bytes, '0', 9);
+    __m128i underscore = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('_'));
+    return _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(letter, digit), underscore));
+}
+
+template <>
+struct Kernels<SimdLevel::SSE2> {
+    static const char* skipSpace(const char* p, const char* end, int& lines) {
+        if (p == end || !isSpace(*p)) return p;
+        while (end - p >= 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i newline = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n'));
+            __m128i space = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')),
+                                                      _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\t'))), newline);
+            unsigned stop = ~_mm_movemask_epi8(space) & 0xFFFFu;
+            unsigned newlines = _mm_movemask_epi8(newline);
+            if (stop) {
+                int n = __builtin_ctz(stop);
+                lines += __builtin_popcount(newlines & ((1u << n) - 1));
+                return p + n;
+            }
+            lines += __builtin_popcount(newlines);
+            p += 16;
+        }
+        return Kernels<SimdLevel::Scalar>::skipSpace(p, end, lines);
+    }
+    static const char* skipIdent(const char* p, const char* end) {
+        if (p == end || !isIdentChar(*p)) return p;
+        while (end - p >= 16) {
+            unsigned stop = ~identMask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) & 0xFFFFu;
+            if (stop) return p + __builtin_ctz(stop);
+            p += 16;
+        }
+        return Kernels<SimdLevel::Scalar>::skipIdent(p, end);
+    }
+    static const char* skipDigits(const char* p, const char* end) {
+        if (p == end || !isDigit(*p)) return p;
+        while (end - p >= 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            unsigned stop = ~_mm_movemask_epi8(inRange(bytes, '0', 9)) & 0xFFFFu;
+            if (stop) return p + __builtin_ctz(stop);
+            p += 16;
+        }
+        return Kernels<SimdLevel::Scalar>::skipDigits(p, end);
+    }
+};
+
+#define SCANNER_AVX2 __attribute__((target("avx2")))
+
+SCANNER_AVX2 inline __m256i inRange256(__m256i bytes, char lo, char span) {
+    __m256i offset = _mm256_sub_epi8(bytes, _mm256_set1_epi8(lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(span)), offset);
+}
+
+template <>
+struct Kernels<SimdLevel::AVX2> {
+    SCANNER_AVX2 static const char* skipSpace(const char* p, const char* end, int& lines) {
+        if (p == end || !isSpace(*p)) return p;
+        while (end - p >= 32) {
+            __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            __m256i newline = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n'));
+            __m256i space = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')),
+                                                            _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\t'))), newline);
+            std::uint32_t stop = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(space));
+            std::uint32_t newlines = static_cast<std::uint32_t>(_mm256_movemask_epi8(newline));
+            if (stop) {
+                int n = __builtin_ctz(stop);
+                lines += __builtin_popcount(newlines & ((1ull << n) - 1));
+                return p + n;
+            }
+            lines += __builtin_popcount(newlines);
+            p += 32;
+        }
+        return Kernels<SimdLevel::SSE2>::skipSpace(p, end, lines);
+    }
+    SCANNER_AVX2 static const char* skipIdent(const char* p, const char* end) {
+        if (p == end || !isIdentChar(*p)) return p;
+        while (end - p >= 32) {
+            __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            __m256i letter = inRange256(_mm256_or_si256(bytes, _mm256_set1_epi8(0x20)), 'a', 25);
+            __m256i digit = inRange256(bytes, '0', 9);
+            __m256i underscore = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('_'));
+            std::uint32_t stop = ~static_cast<std::uint32_t>(
+                _mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(letter, digit), underscore)));
+            if (stop) return p + __builtin_ctz(stop);
+            p += 32;
+        }
+        return Kernels<SimdLevel::SSE2>::skipIdent(p, end);
+    }
+    SCANNER_AVX2 static const char* skipDigits(const char* p, const char* end) {
+        if (p == end || !isDigit(*p)) return p;
+        while (end - p >= 32) {
+            __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            std::uint32_t stop = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(inRange256(bytes, '0', 9)));
+            if (stop) return p + __builtin_ctz(stop);
+            p += 32;
+        }
+        return Kernels<SimdLevel::SSE2>::skipDigits(p, end);
+    }
+};
+
+#endif // SCANNER_X86
+
+} // end anonymous namespace
+
+// --- SIMD level ---
+
+static SimdLevel probeSimdLevel() {
+#if SCANNER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::SSE2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel detected = probeSimdLevel();
+    return detected;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::SSE2:   return "sse2";
+        case SimdLevel::AVX2:   return "avx2";
+    }
+    return "<UNKNOWN_SIMD_LEVEL>";
+}
+
+void Scanner::setSimdLevel(SimdLevel requested) {
+    SimdLevel best = detectSimdLevel();
+    level = static_cast<int>(requested) <= static_cast<int>(best) ? requested : best;
+}
+
+// --- Scanning ---
+
+void Scanner::reset(std::string_view source) {
+    cursor = source.data();
+    end = source.data() + source.size();
+    lastStart = cursor;
+    lineNumber = 1;
+}
+
+static const char* traceName(int token) {
+    switch (token) {
+        case IF:        return "IF";
+        case ELSE:      return "ELSE";
+        case WHILE:     return "WHILE";
+        case FOR:       return "FOR";
+        case SWITCH:    return "SWITCH";
+        case CASE:      return "CASE";
+        case DEFAULT:   return "DEFAULT";
+        case BREAK:     return "BREAK";
+        case IDENT:     return "IDENT";
+        case NUMBER:    return "NUMBER";
+        case INCR:      return "INCR";
+        case DECR:      return "DECR";
+        case PLUS:      return "PLUS";
+        case MINUS:     return "MINUS";
+        case EQ:        return "EQ";
+        case ASSIGN:    return "ASSIGN";
+        case NE:        return "NE";
+        case LE:        return "LE";
+        case LT:        return "LT";
+        case GE:        return "GE";
+        case GT:        return "GT";
+        case MUL:       return "MUL";
+        case DIV:       return "DIV";
+        case MOD:       return "MOD";
+        case SEMICOLON: return "SEMICOLON";
+        case COMMA:     return "COMMA";
+        case LBRACE:    return "LBRACE";
+        case RBRACE:    return "RBRACE";
+        case LPAREN:    return "LPAREN";
+        case RPAREN:    return "RPAREN";
+        case COLON:     return "COLON";
+    }
+    return "<UNKNOWN_TOKEN>";
+}
+
+// acceptToken, inlined into Scanner::next.
+__attribute__((always_inline)) static inline bool completeToken(int token, std::string_view text, int line,
+                                                                YYSTYPE& value, SymbolTable& symbols,
+                                                                Diagnostics& diagnostics) {
+    switch (token) {
+        case 0:
+            return true;
+        case kUnknownCharToken:
+            diagnostics.report("Lexical Error: Unknown character '%.*s' on line %d\n",
+                               (int)text.size(), text.data(), line);
+            return false;
+        case IDENT:
+            value.sym = symbols.intern(text);
+            break;
+        case NUMBER: {
+            // Converted like atoi (saturating, then narrowed to int).
+            long number = 0;
+            for (char c : text) {
+                int digit = c - '0';
+                number = number > (LONG_MAX - digit) / 10 ? LONG_MAX : number * 10 + digit;
+            }
+            value.ival = static_cast<int>(number);
+            break;
+        }
+        default:
+            break;
+    }
+    if (VERBOSITY_ENABLED(VERBOSITY_TRACE)) {
+        // lexer.l quotes the text of these tokens only.
+        bool quoted = token == IDENT || token == NUMBER || token == INCR || token == DECR ||
+                      token == PLUS || token == MINUS;
+        if (quoted) printf("LEX: %s ('%.*s')\n", traceName(token), (int)text.size(), text.data());
+        else printf("LEX: %s\n", traceName(token));
+    }
+    return true;
+}
+
+bool acceptToken(int token, std::string_view text, int line, YYSTYPE& value,
+                 SymbolTable& symbols, Diagnostics& diagnostics) {
+    return completeToken(token, text, line, value, symbols, diagnostics);
+}
+
+int Scanner::next(YYSTYPE& value, SymbolTable& symbols, Diagnostics& diagnostics) {
+    switch (level) {
+#if SCANNER_X86
+        case SimdLevel::AVX2: return nextAvx2(value, symbols, diagnostics);
+        case SimdLevel::SSE2: return nextWith<SimdLevel::SSE2>(value, symbols, diagnostics);
+#endif
+        default:              return nextWith<SimdLevel::Scalar>(value, symbols, diagnostics);
+    }
+}
+
+template <SimdLevel L>
+__attribute__((always_inline)) inline int Scanner::nextWith(YYSTYPE& value, SymbolTable& symbols,
+                                                            Diagnostics& diagnostics) {
+    for (;;) {
+        const char* start;
+        int token = scan<L>(start);
+        lastStart = start;
+        if (completeToken(token, std::string_view(start, cursor - start), lineNumber, value, symbols, diagnostics))
+            return token;
+    }
+}
+
+void Scanner::scanAll(TokenBuffer& tokens, const char* base) {
+    switch (level) {
+#if SCANNER_X86
+        case SimdLevel::AVX2: scanAllAvx2(tokens, base); break;
+        case SimdLevel::SSE2: scanAllWith<SimdLevel::SSE2>(tokens, base); break;
+#endif
+        default:              scanAllWith<SimdLevel::Scalar>(tokens, base); break;
+    }
+    tokens.endLine = lineNumber;
+}
+
+template <SimdLevel L>
+__attribute__((always_inline)) inline void Scanner::scanAllWith(TokenBuffer& tokens, const char* base) {
+    const char* start;
+    while (int token = scan<L>(start)) {
+        tokens.push(token, static_cast<std::uint32_t>(start - base),
+                    static_cast<std::uint32_t>(cursor - start), static_cast<std::uint32_t>(lineNumber));
+    }
+}
+
+template <SimdLevel L>
+__attribute__((always_inline)) inline int Scanner::scan(const char*& start) {
+    using K = Kernels<L>;
+    while (cursor < end) {
+        start = cursor;
+        char c = *cursor;
+
+        // [ \t\n]+
+        if (isSpace(c)) {
+            lineNumber += c == '\n';
+            cursor = K::skipSpace(cursor + 1, end, lineNumber);
+            continue;
+        }
+
+        // Keywords and [a-zA-Z_][a-zA-Z0-9_]*; like flex, the longest match wins, so
+        // "iffy" is an identifier and "if" a keyword.
+        if (isIdentStart(c)) {
+            cursor = K::skipIdent(cursor + 1, end);
+            const Keyword* keyword = findKeyword(start, cursor - start);
+            return keyword ? keyword->token : IDENT;
+        }
+
+        // [0-9]+
+        if (isDigit(c)) {
+            cursor = K::skipDigits(cursor + 1, end);
+            return NUMBER;
+        }
+
+        ++cursor;
+        char following = cursor < end ? *cursor : '\0';
+        switch (c) {
+            case '+': if (following == '+') { ++cursor; return INCR; } return PLUS;
+            case '-': if (following == '-') { ++cursor; return DECR; } return MINUS;
+            case '=': if (following == '=') { ++cursor; return EQ; } return ASSIGN;
+            case '!': if (following == '=') { ++cursor; return NE; } break;
+            case '<': if (following == '=') { ++cursor; return LE; } return LT;
+            case '>': if (following == '=') { ++cursor; return GE; } return GT;
+            case '*': return MUL;
+            case '/': return DIV;
+            case '%': return MOD;
+            case ';': return SEMICOLON;
+            case ',': return COMMA;
+            case '{': return LBRACE;
+            case '}': return RBRACE;
+            case '(': return LPAREN;
+            case ')': return RPAREN;
+            case ':': return COLON;
+            default: break;
+        }
+
+        // Any other single byte (lexer.l's "." rule).
+        return kUnknownCharToken;
+    }
+    start = cursor;
+    return 0;
+}
+
+#if SCANNER_X86
+SCANNER_AVX2 int Scanner::nextAvx2(YYSTYPE& value, SymbolTable& symbols, Diagnostics& diagnostics) {
+    return nextWith<SimdLevel::AVX2>(value, symbols, diagnostics);
+}
+
+SCANNER_AVX2 void Scanner::scanAllAvx2(TokenBuffer& tokens, const char* base) {
+    scanAllWith<SimdLevel::AVX2>(tokens, base);
+}
+#else
+int Scanner::nextAvx2(YYSTYPE& value, SymbolTable& symbols, Diagnostics& diagnostics) {
+    return nextWith<SimdLevel::Scalar>(value, symbols, diagnostics);
+}
+
+void Scanner::scanAllAvx2(TokenBuffer& tokens, const char* base) {
+    scanAllWith<SimdLevel::Scalar>(tokens, base);
+}
+#endif
+
+// --- Whole-source lexing ---
+
+// Sources smaller than this per extra chunk are not worth handing to other threads.
+static const std::size_t kMinLexChunkBytes = 1 << 20;
+// Typical code averages 4-6 bytes a token; reserving for denser text than that keeps the
+// columns from being regrown and copied (untouched capacity costs no physical memory).
+static const std::size_t kBytesPerTokenEstimate = 3;
+
+bool lexTokens(std::string_view source, TokenBuffer& tokens, unsigned workers, SimdLevel level) {
+    tokens.clear();
+    if (source.size() > UINT32_MAX) return false;
+
+    std::size_t chunkCount = 1;
+    if (workers > 1) chunkCount = std::min<std::size_t>(workers * 4, source.size() / kMinLexChunkBytes);
+    if (chunkCount <= 1) {
+        Scanner scanner;
+        scanner.setSimdLevel(level);
+        scanner.reset(source);
+        tokens.reserve(source.size() / kBytesPerTokenEstimate);
+        scanner.scanAll(tokens, source.data());
+        return true;
+    }
+
+    // Chunks end just after a newline. No token contains one, so every chunk lexes to the
+    // same tokens it would have in one pass; only its line numbers start over at 1.
+    std::vector<std::size_t> bounds{0};
+    for (std::size_t i = 1; i < chunkCount; ++i) {
+        std::size_t newline = source.find('\n', std::max(source.size() * i / chunkCount, bounds.back()));
+        if (newline == std::string_view::npos) break;
+        bounds.push_back(newline + 1);
+    }
+    bounds.push_back(source.size());
+    std::size_t chunks = bounds.size() - 1;
+
+    std::vector<TokenBuffer> pieces(chunks);
+    parallelForEach(chunks, workers, [&](std::size_t i, unsigned) {
+        Scanner scanner;
+        scanner.setSimdLevel(level);
+        scanner.reset(source.substr(bounds[i], bounds[i + 1] - bounds[i]));
+        pieces[i].reserve((bounds[i + 1] - bounds[i]) / kBytesPerTokenEstimate);
+        scanner.scanAll(pieces[i], source.data());
+    });
+
+    // Stitch: a chunk's tokens go after all earlier chunks' tokens, and its lines are
+    // shifted by the newlines in the earlier chunks (each piece's endLine - 1).
+    std::vector<std::size_t> first(chunks + 1, 0);
+    std::vector<std::uint32_t> lineShift(chunks, 0);
+    for (std::size_t i = 0; i < chunks; ++i) {
+        first[i + 1] = first[i] + pieces[i].size();
+        if (i > 0) lineShift[i] = lineShift[i - 1] + pieces[i - 1].endLine - 1;
+    }
+    tokens.resize(first[chunks]);
+    tokens.endLine = static_cast<int>(lineShift[chunks - 1]) + pieces[chunks - 1].endLine;
+    parallelForEach(chunks, workers, [&](std::size_t i, unsigned) {
+        const TokenBuffer& piece = pieces[i];
+        std::size_t at = first[i];
+        std::copy(piece.kind.begin(), piece.kind.end(), tokens.kind.begin() + at);
+        std::copy(piece.offset.begin(), piece.offset.end(), tokens.offset.begin() + at);
+        std::copy(piece.length.begin(), piece.length.end(), tokens.length.begin() + at);
+        for (std::size_t t = 0; t < piece.size(); ++t) tokens.line[at + t] = piece.line[t] + lineShift[i];
+        pieces[i] = TokenBuffer();
+    });
+    return true;
+}
@@ -0,0 +1,100 @@
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include "parser.tab.h"   // For token numbers and YYSTYPE
+#include "symbol_table.h" // For SymbolTable
+#include "diagnostics.h"  // For Diagnostics
+#include "token_buffer.h" // For TokenBuffer
+#include <cstddef>
+#include <string_view>
+
+// Instruction set used for the scanner's bulk loops (whitespace, identifier and digit
+// runs). Scalar works everywhere; SSE2 and AVX2 only on x86.
+enum class SimdLevel { Scalar, SSE2, AVX2 };
+
+// Best level this CPU supports.
+SimdLevel detectSimdLevel();
+const char* simdLevelName(SimdLevel level);
+
+// Hand-written scanner over an in-memory source. It accepts exactly the tokens of
+// lexer.l and prints the same trace lines and errors, but keeps all of its state in the
+// object, so independent compilations can scan concurrently (the flex scanner cannot).
+// Runs of whitespace, identifier characters and digits are consumed 16 or 32 bytes at a
+// time, and keywords are recognised with a perfect hash instead of string compares.
+// Scanning is split in two: scan() only finds the kind and extent of each token, and
+// acceptToken() turns that into what the parser sees (the NUMBER/IDENT value, the trace
+// line, the error for an unknown character). scanAll() runs the first half alone, which
+// is what lets lexTokens() lex pieces of one source on several threads.
+class Scanner {
+public:
+    // Starts scanning `source` from line 1. The text must stay alive while scanning.
+    void reset(std::string_view source);
+
+    // Returns the next token (0 at end of input) and fills `value` for NUMBER and IDENT.
+    int next(YYSTYPE& value, SymbolTable& symbols, Diagnostics& diagnostics);
+
+    // Appends every remaining token to `tokens` without interning, logging or reporting
+    // anything: unknown characters are kept as kUnknownCharToken, offsets are measured
+    // from `base` and lines continue from this scanner's. Sets tokens.endLine.
+    void scanAll(TokenBuffer& tokens, const char* base);
+
+    // Line of the most recently scanned token.
+    int line() const { return lineNumber; }
+    // Where the token last returned by next() starts (the end of input after 0).
+    const char* tokenStart() const { return lastStart; }
+
+    // Defaults to detectSimdLevel(); levels the CPU lacks fall back to the best it has.
+    void setSimdLevel(SimdLevel level);
+    SimdLevel simdLevel() const { return level; }
+
+private:
+    // Returns the next token kind (0 at end of input) and points `start` at its text,
+    // which ends at `cursor`.
+    template <SimdLevel L>
+    int scan(const char*& start);
+    template <SimdLevel L>
+    int nextWith(YYSTYPE& value, SymbolTable& symbols, Diagnostics& diagnostics);
+    template <SimdLevel L>
+    void scanAllWith(TokenBuffer& tokens, const char* base);
+    // The AVX2 instances compiled for AVX2 as a whole, so the kernels inline into them.
+    int nextAvx2(YYSTYPE& value, SymbolTable& symbols, Diagnostics& diagnostics);
+    void scanAllAvx2(TokenBuffer& tokens, const char* base);
+
+    const char* cursor = nullptr;
+    const char* end = nullptr;
+    const char* lastStart = nullptr;
+    int lineNumber = 1;
+    SimdLevel level = detectSimdLevel();
+};
+
+// Kind scan() gives a character no rule matches (lexer.l's "." rule). The parser never
+// sees it: acceptToken() reports it and asks for the next token instead.
+constexpr int kUnknownCharToken = YYUNDEF;
+
+// Completes a scanned token: fills `value` for NUMBER and IDENT and prints the trace line,
+// exactly as lexer.l does. For kUnknownCharToken it reports the lexical error and returns
+// false, meaning the token is to be skipped.
+bool acceptToken(int token, std::string_view text, int line, YYSTYPE& value,
+                 SymbolTable& symbols, Diagnostics& diagnostics);
+
+// Lexes all of `source` into `tokens` (see Scanner::scanAll). With more than one worker,
+// sources of a few megabytes and up are cut at newlines into chunks that are lexed on
+// parallelForEach and stitched back in order, so the result never depends on `workers`.
+// Returns false if the source is too large for a TokenBuffer.
+bool lexTokens(std::string_view source, TokenBuffer& tokens, unsigned workers,
+               SimdLevel level = detectSimdLevel());
+
+// --- flex scanner (lexer.l) ---
+// flex keeps its state in globals: callers must serialize everything from flexBegin*()
+// to flexEndSource() (CompilerContext::parse holds a process-wide lock).
+struct CompilerContext;
+int flexLex(YYSTYPE* value, CompilerContext* ctx);
+// Scans a copy of `source`.
+void flexBeginSource(std::string_view source);
+// Scans `text` in place; the two bytes after it must be NUL and the memory writable.
+bool flexBeginBuffer(char* text, std::size_t size);
+void flexEndSource();
+// Line the flex scanner is on.
+int flexLine();
+
+#endif // SCANNER_H
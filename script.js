@@ -1,20 +1,72 @@
-document.getElementById('compileButton').addEventListener('click', () => {
-    const inputCode = document.getElementById('inputCode').value;
-    const outputCodeElement = document.getElementById('outputCode');
+const inputElement = document.getElementById('inputCode');
+const outputCodeElement = document.getElementById('outputCode');
+
+// The page is one document on the server: the first compile sends the whole text,
+// later ones only the range that changed since, and the server reparses just that.
+const docId = Math.random().toString(36).slice(2, 12);
+let sentText = null;     // Text the server has, or null if it needs the whole text
+let inFlight = false;
+let queued = false;      // Another compile was asked for while one was running
+let typingTimer = null;
+
+// Smallest single replacement turning `before` into `after`.
+function editBetween(before, after) {
+    let start = 0;
+    const shorter = Math.min(before.length, after.length);
+    while (start < shorter && before.charCodeAt(start) === after.charCodeAt(start)) start++;
+    let end = 0;
+    while (end < shorter - start &&
+           before.charCodeAt(before.length - 1 - end) === after.charCodeAt(after.length - 1 - end)) end++;
+    // Do not split a surrogate pair.
+    if (start > 0 && (before.charCodeAt(start - 1) & 0xFC00) === 0xD800) start--;
+    if (end > 0 && (after.charCodeAt(after.length - end) & 0xFC00) === 0xDC00) end--;
+    return { offset: start, removed: before.length - start - end, text: after.slice(start, after.length - end) };
+}
+
+function compile() {
+    if (inFlight) {
+        queued = true;
+        return;
+    }
+    const code = inputElement.value;
+    const body = sentText === null ? { doc: docId, code } : { doc: docId, edit: editBetween(sentText, code) };
+    if (sentText === null && !code) return;
+    inFlight = true;
     outputCodeElement.textContent = 'Compiling...';
 
     fetch('http://localhost:3000/compile', {
         method: 'POST',
         headers: { 'Content-Type': 'application/json' },
-        body: JSON.stringify({ code: inputCode }),
+        body: JSON.stringify(body),
     })
-    .then(response => response.text().then(text => ({ ok: response.ok, text })))
-    .then(({ ok, text }) => {
+    .then(response => response.text().then(text => ({ status: response.status, text })))
+    .then(({ status, text }) => {
+        if (status === 409) {
+            sentText = null;   // The server lost the document; resend it whole
+            queued = true;
+            return;
+        }
+        sentText = status === 200 ? code : null;
         outputCodeElement.textContent = text;
     })
     .catch(error => {
         console.error('Fetch error:', error);
+        sentText = null;
         outputCodeElement.textContent = `Error: ${error.message}`;
+    })
+    .finally(() => {
+        inFlight = false;
+        if (queued) {
+            queued = false;
+            compile();
+        }
     });
-});
+}
+
+document.getElementById('compileButton').addEventListener('click', compile);
 
+// Recompile shortly after typing stops.
+inputElement.addEventListener('input', () => {
+    clearTimeout(typingTimer);
+    typingTimer = setTimeout(compile, 300);
+});
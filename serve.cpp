@@ -0,0 +1,176 @@
+#include "serve.h"
+#include "compiler_context.h"
+#include "incremental.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Largest source accepted in one request.
+static const size_t kMaxRequestBytes = 64u << 20;
+// Documents kept for incremental requests; opening one more drops the least recently used.
+static const size_t kMaxDocuments = 16;
+
+struct Request {
+    CompileOptions options;
+    std::string doc;       // doc=<id>: compile the named document instead of a one-off source
+    bool edit = false;     // edit=<offset>,<removed>: the payload replaces that range of the document
+    size_t offset = 0;
+    size_t removed = 0;
+};
+
+struct OpenDocument {
+    std::unique_ptr<IncrementalDocument> document;
+    uint64_t lastUse = 0;
+};
+
+static bool writeResponse(FILE* out, const char* status, const CompileResult& result) {
+    int n = fprintf(out, "%s %zu %zu %zu %zu\n", status, result.ast.size(), result.tac.size(),
+                    result.assembly.size(), result.diagnostics.size());
+    if (n < 0) return false;
+    for (const std::string* text : {&result.ast, &result.tac, &result.assembly, &result.diagnostics}) {
+        if (fwrite(text->data(), 1, text->size(), out) != text->size()) return false;
+    }
+    return fflush(out) == 0;
+}
+
+static bool writeBadRequest(FILE* out, const std::string& message) {
+    CompileResult result;
+    result.diagnostics = message + "\n";
+    return writeResponse(out, "bad-request", result);
+}
+
+// Parses "edit=<offset>,<removed>".
+static bool parseEdit(const std::string& value, Request& request) {
+    const char* text = value.c_str();
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long offset = strtoull(text, &end, 10);
+    if (end == text || *end != ',' || errno != 0) return false;
+    const char* rest = end + 1;
+    unsigned long long removed = strtoull(rest, &end, 10);
+    if (end == rest || *end != '\0' || errno != 0) return false;
+    request.edit = true;
+    request.offset = static_cast<size_t>(offset);
+    request.removed = static_cast<size_t>(removed);
+    return true;
+}
+
+// Parses "<length>[ option]..." into `length` and `request`. Returns an error message, or
+// an empty string on success. An unknown option is reported through `optionError` so the
+// caller can still skip the payload and stay in sync.
+static std::string parseHeader(const std::string& header, size_t& length,
+                               Request& request, std::string& optionError) {
+    CompileOptions& options = request.options;
+    const char* text = header.c_str();
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text || errno != 0 || (*end != '\0' && *end != ' '))
+        return "malformed request header '" + header + "'";
+    if (value > kMaxRequestBytes)
+        return "request of " + std::to_string(value) + " bytes exceeds the limit of " +
+               std::to_string(kMaxRequestBytes);
+    length = static_cast<size_t>(value);
+
+    options.printAST = true;
+    options.print3AC = true;
+    while (*end == ' ') {
+        const char* word = ++end;
+        while (*end != '\0' && *end != ' ') ++end;
+        std::string option(word, end - word);
+        if (option.empty()) continue;
+        if (option == "flat-ast") options.flatAST = true;
+        else if (option == "scanner=flex") options.scanner = ScannerKind::Flex;
+        else if (option == "scanner=builtin") options.scanner = ScannerKind::Builtin;
+        else if (option == "scanner=prelexed") options.scanner = ScannerKind::Prelexed;
+        else if (option == "parser=bison") options.parser = ParserKind::Bison;
+        else if (option == "parser=descent") options.parser = ParserKind::Descent;
+        else if (option == "share-exprs") options.shareExpressions = true;
+        else if (option == "optimize") options.optimize = OptimizeOptions::all();
+        else if (option.compare(0, 4, "doc=") == 0 && option.size() > 4) request.doc = option.substr(4);
+        else if (option.compare(0, 5, "edit=") == 0 && parseEdit(option.substr(5), request)) continue;
+        else if (optionError.empty()) optionError = "unknown request option '" + option + "'";
+    }
+    return std::string();
+}
+
+// Opens (or replaces) document `id` with `text`, evicting the least recently used
+// document when the table is full.
+static IncrementalDocument& openDocument(std::unordered_map<std::string, OpenDocument>& documents,
+                                         const std::string& id, uint64_t now) {
+    auto found = documents.find(id);
+    if (found == documents.end() && documents.size() >= kMaxDocuments) {
+        auto oldest = documents.begin();
+        for (auto it = documents.begin(); it != documents.end(); ++it)
+            if (it->second.lastUse < oldest->second.lastUse) oldest = it;
+        documents.erase(oldest);
+    }
+    OpenDocument& entry = documents[id];
+    if (!entry.document) entry.document.reset(new IncrementalDocument());
+    entry.lastUse = now;
+    return *entry.document;
+}
+
+int runServer(FILE* in, FILE* out) {
+    std::string header;
+    std::string source;
+    std::unordered_map<std::string, OpenDocument> documents;
+    uint64_t requests = 0;
+    for (;;) {
+        header.clear();
+        int c;
+        while ((c = getc(in)) != EOF && c != '\n') header.push_back(static_cast<char>(c));
+        if (c == EOF) {
+            if (header.empty() && !ferror(in)) return 0;
+            writeBadRequest(out, ferror(in) ? "error reading request" : "truncated request header");
+            return 1;
+        }
+
+        size_t length = 0;
+        Request request;
+        std::string optionError;
+        std::string error = parseHeader(header, length, request, optionError);
+        if (!error.empty()) {
+            writeBadRequest(out, error);
+            return 1;
+        }
+
+        source.resize(length);
+        if (fread(&source[0], 1, length, in) != length) {
+            writeBadRequest(out, "truncated request body");
+            return 1;
+        }
+
+        ++requests;
+        bool written;
+        if (!optionError.empty()) {
+            written = writeBadRequest(out, optionError);
+        } else if (request.edit && request.doc.empty()) {
+            written = writeBadRequest(out, "edit= needs doc=");
+        } else if (request.edit) {
+            auto found = documents.find(request.doc);
+            if (found == documents.end()) {
+                written = writeBadRequest(out, "unknown document '" + request.doc + "'");
+            } else if (!found->second.document->edit(request.offset, request.removed, source)) {
+                written = writeBadRequest(out, "edit outside document '" + request.doc + "'");
+            } else {
+                found->second.lastUse = requests;
+                CompileResult result = found->second.document->compile(request.options);
+                written = writeResponse(out, result.ok ? "ok" : "error", result);
+            }
+        } else if (!request.doc.empty()) {
+            IncrementalDocument& document = openDocument(documents, request.doc, requests);
+            document.setText(source);
+            CompileResult result = document.compile(request.options);
+            written = writeResponse(out, result.ok ? "ok" : "error", result);
+        } else {
+            CompileResult result = compile(source, request.options);
+            written = writeResponse(out, result.ok ? "ok" : "error", result);
+        }
+        if (!written) return 1;
+    }
+}
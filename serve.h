@@ -0,0 +1,25 @@
+#ifndef SERVE_H
+#define SERVE_H
+
+#include <cstdio>  // For FILE
+
+// Long-lived compile server (`compiler --serve`). Reads requests from `in` and answers
+// each on `out`, compiling from memory (one-off sources in a fresh CompilerContext);
+// nothing touches disk.
+//
+// Request:   "<length>[ flat-ast][ scanner=builtin|flex|prelexed][ parser=bison|descent][ share-exprs][ optimize]\n" then <length> bytes of source
+// Response:  "<status> <ast> <tac> <asm> <diagnostics>\n" then the four texts back to back,
+//            each header number giving the byte length of the matching text.
+//            status is "ok", "error" (the source did not parse) or "bad-request".
+//
+// Incremental requests name a document kept between requests (see IncrementalDocument):
+//   "<length> doc=<id>"                          the payload becomes the document's whole text
+//   "<length> doc=<id> edit=<offset>,<removed>"  the payload replaces <removed> bytes at <offset>
+// Either way the response is for the whole updated document. An edit to a document the
+// server does not have (never opened, or evicted) is a bad-request; send the text again.
+//
+// Requests are answered in order. Returns 0 at end of input, 1 if the stream could not be
+// read or a header was malformed (the rest of the stream cannot be framed then).
+int runServer(FILE* in, FILE* out);
+
+#endif // SERVE_H
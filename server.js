@@ -1,8 +1,7 @@
 const express = require('express');
 const bodyParser = require('body-parser');
 const cors = require('cors');
-const { exec } = require('child_process');
-const fs = require('fs');
+const { spawn } = require('child_process');
 const path = require('path');
 
 const app = express();
@@ -12,41 +11,123 @@ app.use(cors());
 app.use(bodyParser.json());
 app.use(express.static(__dirname));
 
-app.post('/compile', (req, res) => {
-    const { code } = req.body;
-    if (!code) return res.status(400).send('No code provided.');
+// One long-lived `compiler --serve` process answers every request from memory
+// (protocol in serve.h). Requests are written back to back and answered in order,
+// so each pending entry is resolved by the next response read from stdout.
+const compilerExecutable = path.join(__dirname, 'compiler');
+let daemon = null;
+let pending = [];
+let received = Buffer.alloc(0);
+
+function startDaemon() {
+    const child = spawn(compilerExecutable, ['--serve'], { stdio: ['pipe', 'pipe', 'pipe'] });
+    child.stdout.on('data', (chunk) => {
+        received = Buffer.concat([received, chunk]);
+        readResponses();
+    });
+    child.stderr.on('data', (chunk) => process.stderr.write(chunk));
+    child.stdin.on('error', () => {}); // Reported through 'exit' below
+    child.on('error', (err) => console.error('Failed to start compiler daemon:', err.message));
+    child.on('exit', (code, signal) => {
+        if (daemon === child) daemon = null;
+        received = Buffer.alloc(0);
+        const failed = pending;
+        pending = [];
+        failed.forEach(({ reject }) => reject(new Error(`compiler daemon exited (${signal || code})`)));
+    });
+    return child;
+}
 
-    const tempInputFile = path.join(__dirname, 'temp_input.txt');
-    const compilerExecutable = path.join(__dirname, 'compiler');
-    const asmOutputPath = path.join(__dirname, 'output.asm');
+function readResponses() {
+    while (pending.length > 0) {
+        const newline = received.indexOf(0x0a);
+        if (newline < 0) return;
+        const [status, ...lengths] = received.subarray(0, newline).toString().split(' ');
+        const sizes = lengths.map(Number);
+        const total = sizes.reduce((a, b) => a + b, 0);
+        if (received.length < newline + 1 + total) return;
 
-    fs.writeFile(tempInputFile, code, (err) => {
-        if (err) {
-            console.error('Error writing input file:', err);
-            return res.status(500).send('Failed to write input file.');
+        const fields = [];
+        let offset = newline + 1;
+        for (const size of sizes) {
+            fields.push(received.subarray(offset, offset + size).toString());
+            offset += size;
         }
+        received = received.subarray(offset);
+        const [ast, tac, asm, diagnostics] = fields;
+        pending.shift().resolve({ status, ast, tac, asm, diagnostics });
+    }
+}
 
-        const command = `${compilerExecutable} ${tempInputFile}`;
-        exec(command, (error, stdout, stderr) => {
-            fs.unlink(tempInputFile, () => {});
+function send(payload, options = '') {
+    if (!daemon) daemon = startDaemon();
+    return new Promise((resolve, reject) => {
+        const source = Buffer.from(payload);
+        pending.push({ resolve, reject });
+        daemon.stdin.write(`${source.length}${options}\n`);
+        daemon.stdin.write(source);
+    });
+}
 
-            fs.readFile(asmOutputPath, 'utf8', (readErr, asmCode) => {
-                let output = stdout;
-                if (stderr) output += `\nSTDERR:\n${stderr}`;
+// Editor documents: the daemon keeps each one's tree and reparses only what an edit
+// touches. The text is mirrored here to turn the page's UTF-16 edit positions into the
+// byte offsets the daemon works in.
+const maxDocuments = 64;
+const documents = new Map();
 
-                if (readErr) {
-                    output += `\n\nFailed to read 8086 output: ${readErr.message}`;
-                } else {
-                    output += `\n\n--- 8086 Assembly Output ---\n${asmCode}`;
-                }
+function rememberDocument(doc, text) {
+    documents.delete(doc);
+    documents.set(doc, text);
+    if (documents.size > maxDocuments) documents.delete(documents.keys().next().value);
+}
 
-                res.send(output);
-            });
-        });
+// Resolves to the daemon's response, or null if the document has to be sent whole first.
+function compileRequest({ code, doc, edit }) {
+    if (!doc) return send(code);
+    if (!edit) {
+        rememberDocument(doc, code);
+        return send(code, ` doc=${doc}`);
+    }
+    const previous = documents.get(doc);
+    if (previous === undefined || edit.offset + edit.removed > previous.length) return Promise.resolve(null);
+    const offset = Buffer.byteLength(previous.slice(0, edit.offset));
+    const removed = Buffer.byteLength(previous.slice(edit.offset, edit.offset + edit.removed));
+    rememberDocument(doc, previous.slice(0, edit.offset) + edit.text + previous.slice(edit.offset + edit.removed));
+    return send(edit.text, ` doc=${doc} edit=${offset},${removed}`).then((response) => {
+        if (response.status !== 'bad-request') return response;
+        documents.delete(doc);  // The daemon lost it (restart or eviction)
+        return null;
+    });
+}
+
+app.post('/compile', (req, res) => {
+    const { code, doc, edit } = req.body;
+    if (doc !== undefined && !/^[A-Za-z0-9_-]{1,64}$/.test(doc)) return res.status(400).send('Bad document id.');
+    if (!edit && !code) return res.status(400).send('No code provided.');
+    if (edit && (!doc || typeof edit.text !== 'string' || !Number.isInteger(edit.offset) || !Number.isInteger(edit.removed) ||
+                 edit.offset < 0 || edit.removed < 0)) {
+        return res.status(400).send('Malformed edit.');
+    }
+
+    compileRequest({ code, doc, edit }).then((response) => {
+        if (response === null) return res.status(409).send('Unknown document; send the whole text.');
+        const { status, ast, tac, asm, diagnostics } = response;
+        let output = '';
+        if (status === 'ok') {
+            output += `--- Abstract Syntax Tree ---\n${ast}-----------------------------------\n\n`;
+            output += `${tac}\n`;
+        } else {
+            output += 'Parsing failed.\n';
+        }
+        if (diagnostics) output += `\nSTDERR:\n${diagnostics}`;
+        if (status === 'ok') output += `\n\n--- 8086 Assembly Output ---\n${asm}`;
+        res.send(output);
+    }).catch((err) => {
+        console.error('Compilation failed:', err);
+        res.status(500).send(`Compilation failed: ${err.message}`);
     });
 });
 
 app.listen(port, () => {
     console.log(`Server running at http://localhost:${port}`);
 });
-
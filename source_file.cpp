@@ -0,0 +1,89 @@
+#include "source_file.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>     // For open
+#include <sys/mman.h>  // For mmap, madvise
+#include <sys/stat.h>  // For fstat
+#include <unistd.h>    // For read, close, sysconf
+
+SourceFile::~SourceFile() {
+    release();
+}
+
+void SourceFile::release() {
+    if (mapping) munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+    buffer.clear();
+    base = nullptr;
+    length = 0;
+    discarded = 0;
+}
+
+void SourceFile::discardBefore(std::size_t offset) {
+    if (!mapping) return;
+    std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::size_t end = std::min(offset, length) / page * page;
+    if (end <= discarded) return;
+    madvise(base + discarded, end - discarded, MADV_DONTNEED);
+    discarded = end;
+}
+
+// Reserves zeroed memory one page-rounded size + 2 bytes long and maps the file over its
+// start. The bytes after the end of the file, including the two NULs, are zero either
+// way: in the file's last page the kernel fills the tail with zeros, and any page beyond
+// it still belongs to the anonymous reservation.
+static void* mapWithTerminator(int fd, std::size_t size, std::size_t& mappingSize) {
+    std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::size_t total = (size + 2 + page - 1) / page * page;
+    void* region = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) return nullptr;
+    if (mmap(region, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(region, total);
+        return nullptr;
+    }
+    madvise(region, size, MADV_SEQUENTIAL);
+    mappingSize = total;
+    return region;
+}
+
+bool SourceFile::open(const char* path, std::string& error) {
+    release();
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        mapping = mapWithTerminator(fd, static_cast<std::size_t>(st.st_size), mappingSize);
+        if (mapping) {
+            close(fd);
+            base = static_cast<char*>(mapping);
+            length = static_cast<std::size_t>(st.st_size);
+            return true;
+        }
+        // Fall back to reading (e.g. a file system without mmap support).
+    }
+
+    char chunk[64 * 1024];
+    for (;;) {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n == 0) break;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            error = strerror(errno);
+            close(fd);
+            buffer.clear();
+            return false;
+        }
+        buffer.append(chunk, n);
+    }
+    close(fd);
+    length = buffer.size();
+    buffer.append(2, '\0');
+    base = &buffer[0];
+    return true;
+}
@@ -0,0 +1,47 @@
+#ifndef SOURCE_FILE_H
+#define SOURCE_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Text of one input file. Regular files are memory-mapped, so scanning reads the page
+// cache directly instead of a copy; pipes and other streams are read into a buffer.
+// Either way two NUL bytes follow the text and the memory is private to this object
+// (writes never reach the file), which is what flex needs to scan in place
+// (see CompilerContext::parse(SourceFile&)).
+class SourceFile {
+public:
+    SourceFile() = default;
+    ~SourceFile();
+
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+
+    // Maps or reads `path`. On failure returns false and sets `error` to the reason
+    // (strerror text); callers print it as "<path>: <reason>" like perror.
+    bool open(const char* path, std::string& error);
+
+    std::string_view text() const { return std::string_view(base, length); }
+    char* data() { return base; }
+    std::size_t size() const { return length; }
+    bool mapped() const { return mapping != nullptr; }
+
+    // Tells the kernel the text before `offset` is not needed for now, so its page-cache
+    // pages stop counting towards this process (mapped files only; a read buffer stays).
+    // Reading that text again is still allowed and reads the file again. Pages written
+    // through data() would lose those writes, so only use this on text that was only read.
+    void discardBefore(std::size_t offset);
+
+private:
+    void release();
+
+    void* mapping = nullptr;
+    std::size_t mappingSize = 0;
+    std::string buffer;
+    char* base = nullptr;
+    std::size_t length = 0;
+    std::size_t discarded = 0;  // Bytes from the start already passed to discardBefore
+};
+
+#endif // SOURCE_FILE_H
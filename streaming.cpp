@@ -0,0 +1,70 @@
+#include "streaming.h"
+#include "asm_emitter.h"
+#include "descent_parser.h"
+#include "verbosity.h"
+#include "x8086_generator.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+// Scanned source is handed back in steps of this size, not after every statement.
+static constexpr std::size_t kDiscardStep = 1 << 20;
+
+bool compileStreaming(CompilerContext& ctx, SourceFile& source, const std::string& asmPath,
+                      StreamingStats& stats, std::string& error) {
+    stats = StreamingStats();
+    ctx.root = nullptr;
+    ctx.scanner.reset(source.text());
+
+    Streaming8086 backend(ctx.symbols);
+    std::vector<Quad> quads;
+    std::size_t discarded = 0;
+    bool parsed = parseDescentStatements(ctx, [&](ASTNode* statement) {
+        quads.clear();
+        generate3AC(statement, ctx.tac, quads);
+        backend.add(quads.data(), quads.size());
+        ++stats.statements;
+        stats.quads += quads.size();
+        stats.peakArenaBytes = std::max(stats.peakArenaBytes, ctx.astArena.bytesAllocated());
+
+        // The parser holds nothing from this statement any more (only the next token).
+        ctx.exprs.clear();
+        ctx.astArena.reset();
+        std::size_t scanned = ctx.scanner.tokenStart() - source.text().data();
+        if (scanned - discarded >= kDiscardStep) {
+            source.discardBefore(scanned);
+            discarded = scanned;
+        }
+        return backend.ok();
+    });
+    if (!backend.ok()) {
+        error = "scratch file: " + std::string(strerror(errno));
+        return false;
+    }
+    if (!parsed) return false;
+    LOG_DEBUG("DEBUG: compileStreaming - %zu statements, %zu quads, at most %zu AST bytes at a time.\n",
+              stats.statements, stats.quads, stats.peakArenaBytes);
+
+    AsmEmitter out(ctx.symbols, asmPath);
+    if (!out.ok()) {
+        error = asmPath + ": " + strerror(errno);
+        return false;
+    }
+    LOG_NORMAL("--- Generated 8086 Assembly (also written to %s) ---\n", asmPath.c_str());
+    if (VERBOSITY_ENABLED(VERBOSITY_NORMAL)) {
+        fflush(stdout);
+        out.setEcho(stdout);
+    }
+    bool copied = backend.finish(out);
+    LOG_NORMAL("------------------------------------------------------\n");
+    if (!out.finish()) {
+        error = asmPath + ": " + strerror(errno);
+        return false;
+    }
+    if (!copied) {
+        error = "scratch file: " + std::string(strerror(errno));
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef STREAMING_H
+#define STREAMING_H
+
+#include "compiler_context.h"
+#include "source_file.h"
+#include <cstddef>
+#include <string>
+
+// --- Streaming compilation ---
+// `compiler --stream` compiles a program statement by statement, so memory use does not
+// grow with its length. The normal path keeps the whole AST, the whole quad vector and
+// the whole assembly text alive at once; here each top-level statement is lowered and
+// translated as soon as the parser completes it (Streaming8086), and then its nodes and
+// quads are dropped. What stays is the symbol table, one bit per variable and temp, the
+// largest single statement, and the pages of the source not yet scanned (see
+// SourceFile::discardBefore). The generated program is the same as the normal path's.
+
+struct StreamingStats {
+    std::size_t statements = 0;
+    std::size_t quads = 0;
+    std::size_t peakArenaBytes = 0;  // Most AST memory any one statement needed
+};
+
+// Compiles `source` with ctx's builtin scanner and the descent parser (the bison parser
+// only hands over the finished tree), whatever ctx.scannerKind and ctx.parserKind say.
+// Writes the program to `asmPath` once the whole source has parsed and returns true.
+// On a syntax error returns false and nothing is written; the message is in
+// ctx.diagnostics, after any semantic errors of the statements before it (the normal
+// path reports none in that case, as it never lowers a tree that failed to parse). If
+// writing fails, returns false and sets `error` ("<path>: <reason>" style).
+bool compileStreaming(CompilerContext& ctx, SourceFile& source, const std::string& asmPath,
+                      StreamingStats& stats, std::string& error);
+
+#endif // STREAMING_H
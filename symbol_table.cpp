@@ -0,0 +1,19 @@
+#include "symbol_table.h"
+
+Symbol SymbolTable::intern(std::string_view name) {
+    auto it = ids.find(name);
+    if (it != ids.end()) return it->second;
+
+    // Key the map with the arena copy so the view outlives the caller's buffer.
+    std::string_view stored(storage.copyString(name.data(), name.size()), name.size());
+    Symbol id = static_cast<Symbol>(names.size());
+    names.push_back(stored);
+    ids.emplace(stored, id);
+    return id;
+}
+
+void SymbolTable::clear() {
+    ids.clear();
+    names.clear();
+    storage.reset();
+}
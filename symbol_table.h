@@ -0,0 +1,32 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "arena.h"
+
+// Dense id of an interned identifier. Ids start at 0 and are never reused.
+using Symbol = std::uint32_t;
+
+// Maps each distinct identifier spelling to a Symbol exactly once.
+// The views returned by name() stay valid until clear() or the table is destroyed.
+// Each compilation owns its table (see CompilerContext), so no locking is needed.
+class SymbolTable {
+public:
+    Symbol intern(std::string_view name);
+    std::string_view name(Symbol id) const { return names[id]; }
+    std::size_t size() const { return names.size(); }
+    // Forgets every identifier; ids restart at 0.
+    void clear();
+
+private:
+    Arena storage;
+    std::unordered_map<std::string_view, Symbol> ids;
+    std::vector<std::string_view> names;
+};
+
+#endif // SYMBOL_TABLE_H
@@ -0,0 +1,132 @@
+#!/bin/sh
+# Front-end equivalence: each program is compiled with the builtin scanner and the bison
+# parser, then with the descent parser and with the flex and prelexed scanners, and
+# every run must print the same AST and 3AC, report the same errors and write the same
+# assembly. Generated programs add what does not fit one to a file:
+#   - comparisons chained at one precedence level (syntax errors, since EQ/NE and
+#     LT/LE/GT/GE are %nonassoc)
+#   - nesting just inside the descent parser's limit, and nesting past it, which the
+#     descent parser must report as "memory exhausted" rather than crash
+#   - files ending mid-identifier around the 16- and 32-byte steps of the SIMD scanner
+#   - a program of several megabytes, which --lex-jobs splits into chunks, with and
+#     without an error on its last line
+#
+# Usage: check_frontends.sh compiler program.c...   (exit status 1 if any check fails)
+
+compiler=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+shift
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# kMaxDescentDepth in descent_parser.h.
+max_depth=5000
+
+# nested open close depth inner: `inner` wrapped in `depth` pairs of open/close.
+nested() {
+    awk -v opening="$1" -v closing="$2" -v depth="$3" -v inner="$4" 'BEGIN {
+        for (i = 0; i < depth; i++) printf "%s", opening
+        printf "%s", inner
+        for (i = 0; i < depth; i++) printf "%s", closing
+        printf "\n"
+    }'
+}
+
+printf 'a = b == c != d;\n' > "$work/chained_equality.c"
+printf 'x = 1;\nif (a < b > c) x = 2;\n' > "$work/chained_relational.c"
+printf 'a = b <= c >= d == e;\n' > "$work/chained_mixed.c"
+{
+    printf 'x = '; nested '(' ')' $((max_depth - 10)) 'a + 1'
+    printf ';\n'
+    nested '{' '}' $((max_depth - 10)) 'y = 2;'
+} > "$work/deep_inside_limit.c"
+{ printf 'x = '; nested '(' ')' $((max_depth + 1000)) '1'; printf ';\n'; } > "$work/deep_parens.c"
+nested '{' '}' $((max_depth + 1000)) 'x = 1;' > "$work/deep_blocks.c"
+
+# Input ending inside an identifier, `length` bytes in all.
+for length in 15 16 17 31 32 33 48 64; do
+    awk -v length_="$length" 'BEGIN {
+        printf "x = 1;\ny = "
+        for (i = 11; i < length_; i++) printf "%s", substr("abcdefghijklmnopqrstuvwxyz_0123456789", i % 37 + 1, 1)
+    }' > "$work/eof_ident_$length.c"
+done
+awk 'BEGIN {
+    for (i = 0; i < 100000; i++) printf "total = total + value_%d * 3 - %d;\n", i % 31, i
+    printf "while (total > 100) total = total / 2;\n"
+}' > "$work/large.c"
+{ cat "$work/large.c"; printf 'x = 1 @ 2;\n'; } > "$work/large_error.c"
+
+# compile program options...: the output, errors, exit status and assembly, in one
+# listing on stdout.
+compile() {
+    program=$1
+    shift
+    rm -f "$work/output.asm"
+    (cd "$work" && "$compiler" "$@" "$program" > run.out 2> run.err)
+    code=$?
+    echo "exit $code"
+    cat "$work/run.out"
+    echo "--- stderr"
+    cat "$work/run.err"
+    echo "--- output.asm"
+    [ -f "$work/output.asm" ] && cat "$work/output.asm"
+    return $code
+}
+
+# check program options...: compiles with each front end (plus `options`) and compares
+# each run with the first.
+check() {
+    program=$1
+    shift
+    total=$((total + 1))
+    case $program in /*) source=$program ;; *) source=$PWD/$program ;; esac
+    status=ok
+    compile "$source" "$@" > "$work/reference.listing"
+    if [ $? -ge 128 ]; then
+        status="builtin scanner and bison crashed"
+    else
+        for frontend in --parser=descent --scanner=flex --scanner=prelexed --scanner=prelexed,--lex-jobs=4; do
+            compile "$source" "$@" $(echo "$frontend" | tr , ' ') > "$work/frontend.listing"
+            if [ $? -ge 128 ]; then
+                status="$frontend crashed"
+                break
+            elif ! cmp -s "$work/reference.listing" "$work/frontend.listing"; then
+                status="$frontend differs"
+                diff "$work/reference.listing" "$work/frontend.listing" | head -20
+                break
+            fi
+        done
+    fi
+    [ "$status" = ok ] || failed=$((failed + 1))
+    printf '%-40s %s\n' "$(basename "$program")" "$status"
+}
+
+failed=0
+total=0
+for program in "$@" "$work"/chained_*.c "$work"/deep_inside_limit.c "$work"/eof_ident_*.c; do
+    check "$program"
+done
+# The 3AC listing of these would take most of the time.
+check "$work/large.c" -q
+check "$work/large_error.c" -q
+
+# Past the limit the parsers may disagree (bison's stack is larger), but neither may
+# crash and the descent parser must say why it stopped.
+for program in "$work"/deep_parens.c "$work"/deep_blocks.c; do
+    total=$((total + 1))
+    status=ok
+    compile "$program" -q --parser=bison > /dev/null
+    if [ $? -ge 128 ]; then
+        status="--parser=bison crashed"
+    else
+        compile "$program" -q --parser=descent > "$work/descent.listing"
+        if [ $? -ge 128 ]; then
+            status="--parser=descent crashed"
+        elif ! grep -q "memory exhausted" "$work/descent.listing"; then
+            status="--parser=descent did not report the nesting limit"
+        fi
+    fi
+    [ "$status" = ok ] || failed=$((failed + 1))
+    printf '%-40s %s\n' "$(basename "$program")" "$status"
+done
+echo "check_frontends: $failed of $total programs failed"
+[ $failed -eq 0 ]
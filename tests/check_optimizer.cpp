@@ -0,0 +1,220 @@
+// Regression check for the quad optimizer (optimizer.h): runs every program of the
+// corpus through a small 3AC interpreter before and after each pass, and after -O, and
+// compares the variables' final values. A program's `.expect` file, when there is one,
+// also pins the unoptimised result ("name = value" per line), so a change to the
+// lowering or to 16-bit wraparound cannot hide behind both runs agreeing.
+//
+// Values are 16-bit as on the 8086: + - * wrap, / and % truncate toward zero,
+// comparisons are signed and give 1 or 0. Every variable starts at 0.
+//
+// Usage: check_optimizer program.c...   (exit status 1 if any check fails)
+
+#include "compiler_context.h"
+#include "optimizer.h"
+#include "source_file.h"
+#include "verbosity.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr long kMaxSteps = 10000000;
+
+std::int16_t wrap(long value) {
+    return static_cast<std::int16_t>(static_cast<std::uint16_t>(value & 0xFFFF));
+}
+
+// Final value of every variable, by name. Returns false with `error` set if the program
+// divides by zero, jumps nowhere or runs too long.
+bool interpret(const std::vector<Quad>& quads, const SymbolTable& symbols,
+               std::map<std::string, std::int16_t>& vars, std::string& error) {
+    std::map<int, std::size_t> labels;
+    for (std::size_t i = 0; i < quads.size(); ++i) {
+        if (quads[i].op == QuadOp::Label) labels[quads[i].result.value] = i;
+    }
+    std::map<int, std::int16_t> varValues;
+    std::map<int, std::int16_t> temps;
+    // Only writes create entries, so the final map holds exactly the variables the
+    // program sets; a name only ever read stays out of it (and reads as 0).
+    auto slot = [&](const Operand& operand) -> std::int16_t& {
+        return operand.kind == OperandKind::Var ? varValues[operand.value] : temps[operand.value];
+    };
+    auto value = [&](const Operand& operand) -> std::int16_t {
+        if (operand.kind == OperandKind::Imm) return wrap(operand.value);
+        const std::map<int, std::int16_t>& values = operand.kind == OperandKind::Var ? varValues : temps;
+        auto it = values.find(operand.value);
+        return it == values.end() ? 0 : it->second;
+    };
+    auto jump = [&](const Operand& label, std::size_t& pc) {
+        auto it = labels.find(label.value);
+        if (it == labels.end()) return false;
+        pc = it->second;
+        return true;
+    };
+
+    std::size_t pc = 0;
+    for (long steps = 0; pc < quads.size(); ++steps) {
+        if (steps == kMaxSteps) {
+            error = "no end after " + std::to_string(kMaxSteps) + " quads";
+            return false;
+        }
+        const Quad& q = quads[pc++];
+        long a = value(q.arg1);
+        long b = value(q.arg2);
+        bool jumped = true;
+        switch (q.op) {
+            case QuadOp::Label: break;
+            case QuadOp::Goto: jumped = jump(q.result, pc); break;
+            case QuadOp::IfFalse: if (a == 0) jumped = jump(q.result, pc); break;
+            case QuadOp::If: if (a != 0) jumped = jump(q.result, pc); break;
+            case QuadOp::Assign: slot(q.result) = wrap(a); break;
+            case QuadOp::Add: slot(q.result) = wrap(a + b); break;
+            case QuadOp::Sub: slot(q.result) = wrap(a - b); break;
+            case QuadOp::Mul: slot(q.result) = wrap(a * b); break;
+            case QuadOp::Div:
+            case QuadOp::Mod:
+                if (b == 0) {
+                    error = "division by zero";
+                    return false;
+                }
+                slot(q.result) = wrap(q.op == QuadOp::Div ? a / b : a % b);
+                break;
+            case QuadOp::Lt: slot(q.result) = a < b; break;
+            case QuadOp::Gt: slot(q.result) = a > b; break;
+            case QuadOp::Le: slot(q.result) = a <= b; break;
+            case QuadOp::Ge: slot(q.result) = a >= b; break;
+            case QuadOp::Eq: slot(q.result) = a == b; break;
+            case QuadOp::Ne: slot(q.result) = a != b; break;
+        }
+        if (!jumped) {
+            error = "jump to label L" + std::to_string(q.result.value) + ", which is never placed";
+            return false;
+        }
+    }
+    vars.clear();
+    for (const auto& [symbol, result] : varValues) vars[std::string(symbols.name(symbol))] = result;
+    return true;
+}
+
+std::string describe(const std::map<std::string, std::int16_t>& vars) {
+    std::string text;
+    for (const auto& [name, value] : vars) text += " " + name + "=" + std::to_string(value);
+    return text;
+}
+
+// "name = value" lines; blank lines are skipped.
+bool readExpectations(const std::string& path, std::map<std::string, std::int16_t>& expected) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string name, equals;
+        long value;
+        if (fields >> name >> equals >> value && equals == "=") expected[name] = wrap(value);
+    }
+    return true;
+}
+
+struct Variant {
+    const char* name;
+    OptimizeOptions options;
+};
+
+std::vector<Variant> variants() {
+    std::vector<Variant> list;
+    OptimizeOptions options;
+    options.constants = true;
+    list.push_back({"--const-prop", options});
+    options = OptimizeOptions();
+    options.valueNumbering = true;
+    list.push_back({"--lvn", options});
+    options = OptimizeOptions();
+    options.globalValueNumbering = true;
+    list.push_back({"--gvn", options});
+    options = OptimizeOptions();
+    options.copies = true;
+    list.push_back({"--copy-prop", options});
+    options = OptimizeOptions();
+    options.deadCode = true;
+    list.push_back({"--dce", options});
+    list.push_back({"-O", OptimizeOptions::all()});
+    return list;
+}
+
+// Checks one program; reports every failure on stderr.
+bool check(const char* path) {
+    SourceFile file;
+    std::string error;
+    if (!file.open(path, error)) {
+        fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return false;
+    }
+    CompilerContext ctx;
+    if (!ctx.parse(file.text()) || !ctx.root) {
+        fprintf(stderr, "%s: does not parse\n%s", path, ctx.diagnostics.text().c_str());
+        return false;
+    }
+    std::vector<Quad> quads = ctx.generate3AC();
+    std::map<std::string, std::int16_t> reference;
+    if (!interpret(quads, ctx.symbols, reference, error)) {
+        fprintf(stderr, "%s: unoptimised: %s\n", path, error.c_str());
+        return false;
+    }
+
+    bool ok = true;
+    std::string expectPath = std::string(path, std::string(path).rfind('.')) + ".expect";
+    std::map<std::string, std::int16_t> expected;
+    if (readExpectations(expectPath, expected)) {
+        for (const auto& [name, value] : expected) {
+            auto it = reference.find(name);
+            if (it == reference.end() || it->second != value) {
+                fprintf(stderr, "%s: unoptimised: %s is %s, expected %d\n", path, name.c_str(),
+                        it == reference.end() ? "never set" : std::to_string(it->second).c_str(), value);
+                ok = false;
+            }
+        }
+    }
+
+    std::string summary;
+    for (const Variant& variant : variants()) {
+        std::vector<Quad> optimized = quads;
+        OptimizeStats stats;
+        std::map<std::string, std::int16_t> result;
+        if (!optimizeQuads(optimized, variant.options, stats, error) ||
+            !interpret(optimized, ctx.symbols, result, error)) {
+            fprintf(stderr, "%s: %s: %s\n", path, variant.name, error.c_str());
+            ok = false;
+            continue;
+        }
+        if (result != reference) {
+            fprintf(stderr, "%s: %s changes the result\n    before:%s\n    after: %s\n", path, variant.name,
+                    describe(reference).c_str(), describe(result).c_str());
+            ok = false;
+        }
+        summary += " " + std::string(variant.name) + " " + std::to_string(optimized.size());
+    }
+    printf("%-40s %s (%zu quads;%s)\n", path, ok ? "ok  " : "FAIL", quads.size(), summary.c_str());
+    return ok;
+}
+
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+    verbosityLevel = VERBOSITY_QUIET;
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s program.c...\n", argv[0]);
+        return 1;
+    }
+    int failed = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (!check(argv[i])) ++failed;
+    }
+    printf("check_optimizer: %d of %d programs failed\n", failed, argc - 1);
+    return failed ? 1 : 0;
+}
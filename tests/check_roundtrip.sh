@@ -0,0 +1,35 @@
+#!/bin/sh
+# Round trip of optimised output: each program is compiled with -O while saving its IR
+# and 3AC listing (--write-ir, --write-3ac), and both are read back (--read-ir,
+# --read-3ac). Reading must succeed and give the same assembly. One generated program
+# also checks that temp and label numbers stay in range when -O drops most quads.
+#
+# Usage: check_roundtrip.sh compiler program.c...   (exit status 1 if any check fails)
+
+compiler=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+shift
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+i=0
+while [ $i -lt 70000 ]; do echo "1 + 2;"; i=$((i + 1)); done > "$work/many_temps.c"
+echo "while (a < b) a = a + 1;" >> "$work/many_temps.c"
+
+failed=0
+total=0
+for program in "$@" "$work/many_temps.c"; do
+    total=$((total + 1))
+    case $program in /*) source=$program ;; *) source=$PWD/$program ;; esac
+    status=ok
+    if ! (cd "$work" && "$compiler" -q -O --write-ir=saved.ir --write-3ac=saved.3ac "$source" && mv output.asm direct.asm); then
+        status="compile failed"
+    elif ! (cd "$work" && "$compiler" -q --read-ir saved.ir && cmp -s direct.asm output.asm); then
+        status="--read-ir differs"
+    elif ! (cd "$work" && "$compiler" -q --read-3ac saved.3ac && cmp -s direct.asm output.asm); then
+        status="--read-3ac differs"
+    fi
+    [ "$status" = ok ] || failed=$((failed + 1))
+    printf '%-40s %s\n' "$(basename "$program")" "$status"
+done
+echo "check_roundtrip: $failed of $total programs failed"
+[ $failed -eq 0 ]
@@ -0,0 +1,81 @@
+#!/bin/sh
+# Incremental documents in --serve: a document is opened and then edited request by
+# request (see IncrementalDocument), and after every edit the server's response must be
+# byte for byte the one it gives for the edited text sent whole, as a one-off source:
+# same status, AST, 3AC, assembly and messages. The edits land at the start and at the
+# end of a statement's span, take an `else` away from an `if` and give one back (to an
+# outer and to a nested `if`), and introduce a syntax error and repair it.
+#
+# Usage: check_serve.sh compiler   (exit status 1 if any check fails)
+
+compiler=$1
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+cat > "$work/text" <<'EOF'
+x = 10;
+y = 20;
+if (x < y)
+    z = y - x;
+else
+    z = x - y;
+while (x < 15) x = x + 1;
+if (x > 1) if (y > 1) w = z;
+v = w;
+EOF
+
+# Both request streams so far: the document's, and the same texts as one-off sources.
+printf '%d doc=d\n' "$(wc -c < "$work/text")" > "$work/session"
+cat "$work/text" >> "$work/session"
+printf '%d\n' "$(wc -c < "$work/text")" > "$work/whole"
+cat "$work/text" >> "$work/whole"
+
+failed=0
+total=0
+
+# compare description: runs both streams; the responses must be identical.
+compare() {
+    total=$((total + 1))
+    status=ok
+    "$compiler" --serve < "$work/session" > "$work/session.out"
+    "$compiler" --serve < "$work/whole" > "$work/whole.out"
+    if ! cmp -s "$work/session.out" "$work/whole.out"; then
+        status="differs from a full compile"
+        diff "$work/whole.out" "$work/session.out" | head -20
+    fi
+    [ "$status" = ok ] || failed=$((failed + 1))
+    printf '%-50s %s\n' "$1" "$status"
+}
+
+# edit description needle removed inserted: replaces `removed` bytes at the first
+# `needle` in the document with `inserted` (a printf format).
+edit() {
+    offset=$(grep -bo -F -- "$2" "$work/text" | head -1 | cut -d: -f1)
+    if [ -z "$offset" ]; then
+        echo "check_serve: '$2' is not in the document"
+        exit 1
+    fi
+    printf "$4" > "$work/inserted"
+    { head -c "$offset" "$work/text"; cat "$work/inserted"; tail -c +$((offset + $3 + 1)) "$work/text"; } > "$work/edited"
+    mv "$work/edited" "$work/text"
+    printf '%d doc=d edit=%d,%d\n' "$(wc -c < "$work/inserted")" "$offset" "$3" >> "$work/session"
+    cat "$work/inserted" >> "$work/session"
+    printf '%d\n' "$(wc -c < "$work/text")" >> "$work/whole"
+    cat "$work/text" >> "$work/whole"
+    compare "$1"
+}
+
+compare "open"
+edit "insert at a span start" "y = 20;" 0 'a = 1;\n'
+edit "replace up to a span end" "20;" 4 '30;\n'
+edit "append at the end" "v = w;" 7 'v = w;\nu = v;\n'
+edit "remove an else" "else" 19 ''
+edit "add an else to the if before" "while" 0 'else z = 0;\n'
+edit "add an else to a nested if" "v = w;" 0 'else w = 1;\n'
+edit "remove the nested else" "else w = 1;" 12 ''
+edit "introduce a syntax error" "x + 1" 5 'x + '
+edit "edit elsewhere while broken" "a = 1;" 6 'a = 2;'
+edit "repair the syntax error" "x + ;" 5 'x + 2;'
+
+echo "check_serve: $failed of $total checks failed"
+[ $failed -eq 0 ]
@@ -0,0 +1,10 @@
+xif = 1; _if = 2; ifx = 3; if1 = 4;
+xelse = 1; _else = 2; elsex = 3; else1 = 4;
+xwhile = 1; _while = 2; whilex = 3; while1 = 4;
+xfor = 1; _for = 2; forx = 3; for1 = 4;
+xswitch = 1; _switch = 2; switchx = 3; switch1 = 4;
+xcase = 1; _case = 2; casex = 3; case1 = 4;
+xdefault = 1; _default = 2; defaultx = 3; default1 = 4;
+xbreak = 1; _break = 2; breakx = 3; break1 = 4;
+if (xif < ifx) xelse = elsex + while1; else _for = for_ - switch1;
+while (casex < 3) casex = casex + 1;
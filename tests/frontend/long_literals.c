@@ -0,0 +1,5 @@
+x = 99999999999999999999;
+y = 4294967297;
+z = 2147483648 + 65536;
+w = 000000000000000000000000000000000000000000012;
+v = 32767 + 32768 + 65535 + 65536;
@@ -0,0 +1,14 @@
+a = 1 + 2 * 3 - 4 / 2 % 3;
+b = a - 3 - 2;
+c = 64 / 4 / 2 % 5;
+d = a < b == c > d;
+e = a == b < c;
+f = a + b < c * d;
+g = (a + b) * (c - d) % 7;
+h = a <= b != (c >= d);
+i = x++ + ++y * z-- - --w;
+j = ((a)) - (b - (c - d));
+k = 1 + (2 == 3) * 4 + 5 != 6;
+if (a + 1 != b - 1 == c) k = k + 1; else k = k - 1;
+while (i < 10 == 1) i = i + 2 * 3 % 4;
+for (m = 0; m <= 3 + 1; m++) n = n * 2 + m / 2;
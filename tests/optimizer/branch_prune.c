@@ -0,0 +1,24 @@
+k = 3;
+if (k > 5) {
+    x = 1;
+} else {
+    x = 2;
+}
+if (k == 3)
+    y = 10;
+while (k < 3) {
+    y = 9;
+    k++;
+}
+for (; k > 10; k--)
+    y = y + 1;
+switch (k) {
+    case 1: z = 10; break;
+    case 3: z = 30; break;
+    default: z = 0;
+}
+if ((x + 1) != 3) {
+    w = 1;
+} else {
+    w = 2;
+}
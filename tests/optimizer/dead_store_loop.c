@@ -0,0 +1,24 @@
+s = 100;
+s = 5;
+i = 0;
+while (i < 4) {
+    t = s;
+    s = i;
+    unused = i * 7;
+    unused = 0;
+    i++;
+}
+u = t;
+j = 0;
+acc = 1;
+while (j < 3) {
+    acc = 0;
+    acc = acc + j;
+    j++;
+}
+if (u > 100) {
+    v = 1;
+    v = 2;
+} else {
+    v = 3;
+}
@@ -0,0 +1,10 @@
+a = 32767 + 1;
+b = 200 * 200;
+c = 0 - 32768 - 1;
+d = 0 - 7 / 2;
+e = (0 - 7) % 3;
+f = 7 % (0 - 3);
+g = 65535 + 2;
+h = (0 - 1) < 1;
+k = 40000 > 1;
+m = a - 1 + b * 2;
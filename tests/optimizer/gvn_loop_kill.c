@@ -0,0 +1,23 @@
+a = 3;
+b = 4;
+x = a * b;
+i = 0;
+while (i < 3) {
+    y = a * b;
+    a = a + 1;
+    i++;
+}
+z = a * b;
+w = a * b + a * b;
+if (z > 20) {
+    p = a * b - 1;
+} else {
+    p = b * a;
+}
+q = b * a + 1;
+n = 0;
+while (n < 2) {
+    r = q + 1;
+    q = r * 2;
+    n++;
+}
@@ -0,0 +1,14 @@
+i = 5;
+i++;
+i++;
+--i;
+++i;
+i--;
+count = 0;
+for (; i > 0; i--)
+    count++;
+j = 10;
+while (j > 7) {
+    --j;
+    total = total + j;
+}
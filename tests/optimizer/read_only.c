@@ -0,0 +1,5 @@
+a = y;
+c = a + 1;
+a = b;
+d = z;
+d = 2;
@@ -0,0 +1,12 @@
+b = 4;
+x = 1 + 2;
+x = 1 + 2;
+x = 1 + 2;
+x = 1 + 2;
+x = 1 + 2;
+x = 1 + 2;
+x = 1 + 2;
+x = 1 + 2;
+x = 1 + 2;
+x = 1 + 2;
+while (a < b) a = a + 1;
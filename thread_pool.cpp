@@ -0,0 +1,74 @@
+#include "thread_pool.h"
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct WorkQueue {
+    std::mutex mutex;
+    std::deque<std::size_t> tasks;
+
+    bool popBack(std::size_t& task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty()) return false;
+        task = tasks.back();
+        tasks.pop_back();
+        return true;
+    }
+
+    bool stealFront(std::size_t& task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty()) return false;
+        task = tasks.front();
+        tasks.pop_front();
+        return true;
+    }
+};
+
+} // end anonymous namespace
+
+unsigned defaultWorkerCount() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+void parallelForEach(std::size_t taskCount, unsigned workers,
+                     const std::function<void(std::size_t, unsigned)>& body) {
+    if (taskCount == 0) return;
+    if (workers == 0) workers = 1;
+    if (workers > taskCount) workers = static_cast<unsigned>(taskCount);
+
+    // Contiguous slices keep neighbouring inputs (often of similar size) on one worker.
+    // Tasks are never added after this point, so an empty sweep over every queue means
+    // all work has been handed out.
+    std::vector<WorkQueue> queues(workers);
+    for (unsigned w = 0; w < workers; ++w) {
+        std::size_t begin = taskCount * w / workers;
+        std::size_t end = taskCount * (w + 1) / workers;
+        for (std::size_t task = begin; task < end; ++task) queues[w].tasks.push_back(task);
+    }
+
+    auto work = [&](unsigned self) {
+        std::size_t task;
+        for (;;) {
+            if (queues[self].popBack(task)) {
+                body(task, self);
+                continue;
+            }
+            bool stole = false;
+            for (unsigned i = 1; i < workers && !stole; ++i) {
+                stole = queues[(self + i) % workers].stealFront(task);
+            }
+            if (!stole) return;
+            body(task, self);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (unsigned w = 1; w < workers; ++w) threads.emplace_back(work, w);
+    work(0);
+    for (std::thread& thread : threads) thread.join();
+}
@@ -0,0 +1,18 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <cstddef>
+#include <functional>
+
+// Runs body(task, worker) once for every task in [0, taskCount) on `workers` threads
+// (worker numbers 0 .. workers-1; the calling thread is worker 0) and returns when all
+// tasks are done. Tasks start out split evenly across per-worker deques; a worker takes
+// from the back of its own deque and, once that is empty, steals from the front of the
+// others', so a few slow tasks do not leave the remaining threads idle.
+void parallelForEach(std::size_t taskCount, unsigned workers,
+                     const std::function<void(std::size_t task, unsigned worker)>& body);
+
+// Worker count to use when none is given: the number of hardware threads (at least 1).
+unsigned defaultWorkerCount();
+
+#endif // THREAD_POOL_H
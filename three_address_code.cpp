@@ -1,187 +1,494 @@
 #include "three_address_code.h"
+#include "packed_ast.h"
+#include "verbosity.h"
 #include <iostream>
 #include <string>
 #include <vector>
 #include <cstdio>
 
-static int tempCount = 0;
-static int labelCount = 0;
-static std::string currentBreakLabel = "";
+// --- Quad text helpers (printing only) ---
 
-std::string newTemp() { return "t" + std::to_string(++tempCount); }
-std::string newLabel() { return "L" + std::to_string(++labelCount); }
+bool isRelationalOp(QuadOp op) {
+    return op == QuadOp::Lt || op == QuadOp::Gt || op == QuadOp::Le ||
+           op == QuadOp::Ge || op == QuadOp::Eq || op == QuadOp::Ne;
+}
 
-std::string safe_s(const char* s) {
-    if (s == nullptr) return "<NULL_SVAL_ERROR_IN_3AC>";
-    return std::string(s);
+const char* quadOpText(QuadOp op) {
+    switch (op) {
+        case QuadOp::Assign:  return "=";
+        case QuadOp::Add:     return "+";
+        case QuadOp::Sub:     return "-";
+        case QuadOp::Mul:     return "*";
+        case QuadOp::Div:     return "/";
+        case QuadOp::Mod:     return "%";
+        case QuadOp::Lt:      return "<";
+        case QuadOp::Gt:      return ">";
+        case QuadOp::Le:      return "<=";
+        case QuadOp::Ge:      return ">=";
+        case QuadOp::Eq:      return "==";
+        case QuadOp::Ne:      return "!=";
+        case QuadOp::Label:   return "label";
+        case QuadOp::Goto:    return "goto";
+        case QuadOp::IfFalse: return "ifFalse";
+        case QuadOp::If:      return "if";
+    }
+    return "<UNKNOWN_QUAD_OP>";
 }
-std::string safe_s(const std::string& s) { return s; }
 
-std::string generate3ACHelper(ASTNode* node, std::vector<Quad>& quads);
+void appendOperandText(std::string& out, const Operand& operand, const SymbolTable& symbols) {
+    switch (operand.kind) {
+        case OperandKind::None:
+            break;
+        case OperandKind::Temp:
+            out += 't';
+            out += std::to_string(operand.value);
+            break;
+        case OperandKind::Var:
+            out += symbols.name(static_cast<Symbol>(operand.value));
+            break;
+        case OperandKind::Imm:
+            out += std::to_string(operand.value);
+            break;
+        case OperandKind::Label:
+            out += 'L';
+            out += std::to_string(operand.value);
+            break;
+    }
+}
 
-std::vector<Quad> generate3AC(ASTNode* node) {
-    printf("DEBUG: generate3AC - Top level function called (Normal 3AC Generation).\n");
-    fflush(stdout);
-    std::vector<Quad> quads;
-    tempCount = 0;
-    labelCount = 0;
-    currentBreakLabel = "";
-    generate3ACHelper(node, quads);
-    printf("DEBUG: generate3AC - Finished generating %zu quads.\n", quads.size());
-    fflush(stdout);
-    return quads;
+std::string operandText(const Operand& operand, const SymbolTable& symbols) {
+    std::string text;
+    appendOperandText(text, operand, symbols);
+    return text;
+}
+
+std::string quadText(const Quad& q, const SymbolTable& symbols) {
+    auto text = [&](const Operand& operand) { return operandText(operand, symbols); };
+    switch (q.op) {
+        case QuadOp::Assign:  return text(q.result) + " = " + text(q.arg1);
+        case QuadOp::Label:   return text(q.result) + ":";
+        case QuadOp::Goto:    return "goto " + text(q.result);
+        case QuadOp::IfFalse: return "ifFalse " + text(q.arg1) + " goto " + text(q.result);
+        case QuadOp::If:      return "if " + text(q.arg1) + " goto " + text(q.result);
+        default:
+            return text(q.result) + " = " + text(q.arg1) + " " + quadOpText(q.op) + " " + text(q.arg2);
+    }
+}
+
+void print3AC(const std::vector<Quad>& quads, const SymbolTable& symbols, std::ostream& out) {
+    out << "--- Three-Address Code ---" << std::endl;
+    if (VERBOSITY_ENABLED(VERBOSITY_DEBUG))
+        out << "DEBUG: print3AC - Entered. Number of quads: " << quads.size() << std::endl;
+
+    for (const auto& q : quads) {
+        out << quadText(q, symbols) << std::endl;
+    }
+
+    if (VERBOSITY_ENABLED(VERBOSITY_DEBUG))
+        out << "DEBUG: print3AC - Exited normally after processing " << quads.size() << " quads." << std::endl;
+    out << "-----------------------------------" << std::endl;
 }
 
-std::string generate3ACHelper(ASTNode* node, std::vector<Quad>& quads) {
-    if (!node) return "<NULL_AST_NODE_ERROR>";
+// --- Reading a listing back (parse3AC) ---
 
-    if (node->type == "stmt_list") {
-        if (node->left) generate3ACHelper(node->left, quads);
-        if (node->right) generate3ACHelper(node->right, quads);
-        return "";
+namespace {
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+bool isIdentStart(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+bool isIdentChar(char c) { return isIdentStart(c) || isDigit(c); }
+
+// Decimal digits, optionally after a '-', that fit an int32.
+bool parseNumber(std::string_view text, std::int32_t& value) {
+    std::size_t i = text.size() > 1 && text[0] == '-' ? 1 : 0;
+    if (i == text.size()) return false;
+    std::int64_t magnitude = 0;
+    for (; i < text.size(); ++i) {
+        if (!isDigit(text[i])) return false;
+        magnitude = magnitude * 10 + (text[i] - '0');
+        if (magnitude > 2147483648LL) return false;
     }
+    std::int64_t result = text[0] == '-' ? -magnitude : magnitude;
+    if (result > INT32_MAX) return false;
+    value = static_cast<std::int32_t>(result);
+    return true;
+}
 
-    if (node->type == "assign") {
-        std::string rhs_str = generate3ACHelper(node->left, quads);
-        quads.push_back({"=", safe_s(rhs_str), "", safe_s(node->value)});
-        return "";
+// `prefix` followed by a non-negative number, e.g. "t12" or "L3".
+bool parseNumbered(std::string_view text, char prefix, std::int32_t& value) {
+    return text.size() > 1 && text[0] == prefix && isDigit(text[1]) && parseNumber(text.substr(1), value);
+}
+
+bool parseBinaryOp(std::string_view text, QuadOp& op) {
+    static const QuadOp kOps[] = {QuadOp::Add, QuadOp::Sub, QuadOp::Mul, QuadOp::Div, QuadOp::Mod,
+                                  QuadOp::Lt, QuadOp::Gt, QuadOp::Le, QuadOp::Ge, QuadOp::Eq, QuadOp::Ne};
+    for (QuadOp candidate : kOps) {
+        if (text == quadOpText(candidate)) {
+            op = candidate;
+            return true;
+        }
     }
+    return false;
+}
 
-    if (node->type == "id") return safe_s(node->value);
-    if (node->type == "num") return safe_s(node->value);
+class ListingReader {
+public:
+    ListingReader(SymbolTable& symbols, std::vector<Quad>& quads) : symbols(symbols), quads(quads) {}
 
-    if (node->type == "op") {
-        if (node->value == "++" || node->value == "--") {
-            std::string var = generate3ACHelper(node->left, quads);
-            std::string one = "1";
-            std::string temp = newTemp();
-            std::string op = (node->value == "++") ? "+" : "-";
-            quads.push_back({op, var, one, temp});
-            quads.push_back({"=", temp, "", var});
-            return var;
+    // Reads one line holding at most kMaxWords words. Returns an error message or nullptr.
+    const char* readLine(std::string_view line) {
+        std::size_t count = 0;
+        std::size_t i = 0;
+        while (i < line.size()) {
+            while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) ++i;
+            if (i == line.size() || line[i] == '#') break;
+            std::size_t start = i;
+            while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r') ++i;
+            if (count == kMaxWords) return "too many words for a quad";
+            words[count++] = line.substr(start, i - start);
         }
-        std::string left_operand = generate3ACHelper(node->left, quads);
-        std::string right_operand = generate3ACHelper(node->right, quads);
-        std::string temp_var = newTemp();
-        quads.push_back({safe_s(node->value), safe_s(left_operand), safe_s(right_operand), safe_s(temp_var)});
-        return temp_var;
-    }
-
-    if (node->type == "if") {
-        std::string cond_result = generate3ACHelper(node->left, quads);
-        std::string else_label = newLabel();
-        quads.push_back({"ifFalse", safe_s(cond_result), "", safe_s(else_label)});
-        if (node->right) generate3ACHelper(node->right, quads);
-        if (node->third) {
-            std::string end_label = newLabel();
-            quads.push_back({"goto", "", "", safe_s(end_label)});
-            quads.push_back({"label", "", "", safe_s(else_label)});
-            generate3ACHelper(node->third, quads);
-            quads.push_back({"label", "", "", safe_s(end_label)});
+        if (count == 0) return nullptr;
+        if (words[0].substr(0, 3) == "---" || words[0] == "DEBUG:") return nullptr;
+
+        Quad quad{QuadOp::Assign, noOperand(), noOperand(), noOperand()};
+        if (count == 1) {
+            // "L1:"
+            std::string_view word = words[0];
+            if (word.back() != ':' || !label(word.substr(0, word.size() - 1), quad.result))
+                return "expected a label definition (\"L<n>:\")";
+            quad.op = QuadOp::Label;
+        } else if (count >= 3 && words[1] == "=") {
+            // "x = a" or "t1 = a op b"
+            if (!operand(words[0], quad.result) || quad.result.kind == OperandKind::Imm)
+                return "expected a variable or temp before '='";
+            if (!operand(words[2], quad.arg1)) return "expected an operand after '='";
+            if (count == 5) {
+                if (!parseBinaryOp(words[3], quad.op)) return "unknown operator";
+                if (!operand(words[4], quad.arg2)) return "expected an operand after the operator";
+            } else if (count != 3) {
+                return "expected \"x = a\" or \"x = a op b\"";
+            }
+        } else if (count == 2 && words[0] == "goto") {
+            if (!label(words[1], quad.result)) return "expected a label after 'goto'";
+            quad.op = QuadOp::Goto;
+        } else if (count == 4 && (words[0] == "ifFalse" || words[0] == "if") && words[2] == "goto") {
+            quad.op = words[0] == "if" ? QuadOp::If : QuadOp::IfFalse;
+            if (!operand(words[1], quad.arg1)) return "expected a condition operand";
+            if (!label(words[3], quad.result)) return "expected a label after 'goto'";
         } else {
-            quads.push_back({"label", "", "", safe_s(else_label)});
+            return "not a quad";
+        }
+        quads.push_back(quad);
+        return nullptr;
+    }
+
+    std::int32_t highestNumber() const { return highest; }
+
+private:
+    static constexpr std::size_t kMaxWords = 5;
+
+    bool label(std::string_view text, Operand& out) {
+        std::int32_t n;
+        if (!parseNumbered(text, 'L', n)) return false;
+        note(n);
+        out = labelOperand(n);
+        return true;
+    }
+
+    bool operand(std::string_view text, Operand& out) {
+        std::int32_t n;
+        if (parseNumbered(text, 't', n)) {
+            note(n);
+            out = tempOperand(n);
+            return true;
         }
-        return "";
-    }
-
-    if (node->type == "while") {
-        std::string start_label = newLabel();
-        std::string end_label = newLabel();
-        std::string old_break = currentBreakLabel;
-        currentBreakLabel = end_label;
-        quads.push_back({"label", "", "", start_label});
-        if (node->left) {
-            std::string cond_res = generate3ACHelper(node->left, quads);
-            quads.push_back({"ifFalse", cond_res, "", end_label});
+        if (isDigit(text[0]) || text[0] == '-') {
+            if (!parseNumber(text, n)) return false;
+            out = immOperand(n);
+            return true;
         }
-        if (node->right) generate3ACHelper(node->right, quads);
-        quads.push_back({"goto", "", "", start_label});
-        quads.push_back({"label", "", "", end_label});
-        currentBreakLabel = old_break;
-        return "";
-    }
-
-    if (node->type == "for") {
-        if (node->left) generate3ACHelper(node->left, quads);
-        std::string start_label = newLabel();
-        std::string end_label = newLabel();
-        std::string old_break = currentBreakLabel;
-        currentBreakLabel = end_label;
-        quads.push_back({"label", "", "", start_label});
-        if (node->right) {
-            std::string cond_res = generate3ACHelper(node->right, quads);
-            quads.push_back({"ifFalse", cond_res, "", end_label});
+        if (!isIdentStart(text[0])) return false;
+        for (char c : text) {
+            if (!isIdentChar(c)) return false;
         }
-        if (node->fourth) generate3ACHelper(node->fourth, quads);
-        if (node->third) generate3ACHelper(node->third, quads);
-        quads.push_back({"goto", "", "", start_label});
-        quads.push_back({"label", "", "", end_label});
-        currentBreakLabel = old_break;
-        return "";
+        out = varOperand(symbols.intern(text));
+        return true;
     }
 
-    if (node->type == "break") {
-        if (currentBreakLabel.empty()) {
-            fprintf(stderr, "Semantic Error: 'break' statement not within a loop or switch.\n");
-            fflush(stderr);
-        } else {
-            quads.push_back({"goto", "", "", currentBreakLabel});
+    void note(std::int32_t n) {
+        if (n > highest) highest = n;
+    }
+
+    SymbolTable& symbols;
+    std::vector<Quad>& quads;
+    std::string_view words[kMaxWords];
+    std::int32_t highest = 0;
+};
+
+} // end anonymous namespace
+
+bool parse3AC(std::string_view text, SymbolTable& symbols, std::vector<Quad>& quads, std::string& error) {
+    std::size_t first = quads.size();
+    quads.reserve(first + text.size() / 16);  // A printed quad takes about 16 bytes
+    ListingReader reader(symbols, quads);
+    std::size_t lineNumber = 0;
+    for (std::size_t start = 0; start < text.size();) {
+        std::size_t end = text.find('\n', start);
+        if (end == std::string_view::npos) end = text.size();
+        ++lineNumber;
+        if (const char* message = reader.readLine(text.substr(start, end - start))) {
+            error = "line " + std::to_string(lineNumber) + ": " + message;
+            quads.resize(first);
+            return false;
         }
-        return "";
-    }
-
-    if (node->type == "switch") {
-        std::string expr = generate3ACHelper(node->left, quads);
-        std::string end_label = newLabel();
-        std::string old_break = currentBreakLabel;
-        currentBreakLabel = end_label;
-
-        ASTNode* case_list = node->right;
-        std::vector<std::pair<std::string, ASTNode*>> cases;
-        ASTNode* default_stmt = nullptr;
-
-        // Traverse case_list
-        while (case_list) {
-            ASTNode* case_node = case_list->right;
-            if (!case_node) break;
-
-            if (case_node->type == "case") {
-                std::string case_val = generate3ACHelper(case_node->left, quads);
-                std::string label = newLabel();
-                std::string cond = newTemp();
-                quads.push_back({"==", expr, case_val, cond});
-                quads.push_back({"if", cond, "", label});
-                cases.push_back({label, case_node->right});
-            } else if (case_node->type == "default") {
-                default_stmt = case_node->right;
-            }
+        start = end + 1;
+    }
+    std::int64_t limit = static_cast<std::int64_t>(quads.size() - first) + k3ACNumberSlack;
+    if (reader.highestNumber() > limit) {
+        error = "temp or label number " + std::to_string(reader.highestNumber()) + " is out of range for " +
+                std::to_string(quads.size() - first) + " quads";
+        quads.resize(first);
+        return false;
+    }
+    return true;
+}
+
+// Quad opcode for each binary OpKind, indexed by the enum value (Add .. Ne).
+static const QuadOp kBinaryQuadOp[] = {
+    QuadOp::Add, QuadOp::Sub, QuadOp::Mul, QuadOp::Div, QuadOp::Mod,
+    QuadOp::Lt, QuadOp::Gt, QuadOp::Le, QuadOp::Ge, QuadOp::Eq, QuadOp::Ne,
+};
+
+// One lowering run: the caller's numbering state and the quad list being appended to.
+struct Lowering {
+    TACState& state;
+    std::vector<Quad>& quads;
 
-            case_list = case_list->left;
+    Operand newTemp() { return tempOperand(++state.tempCount); }
+    Operand newLabel() { return labelOperand(++state.labelCount); }
+};
+
+template <typename Node>
+static Operand generate3ACHelper(Node node, Lowering& lw);
+
+std::vector<Quad> generate3AC(ASTNode* node) {
+    std::vector<Quad> quads;
+    TACState state;
+    generate3AC(node, state, quads);
+    return quads;
+}
+
+void generate3AC(ASTNode* node, TACState& state, std::vector<Quad>& quads) {
+    LOG_DEBUG("DEBUG: generate3AC - Top level function called (Normal 3AC Generation).\n");
+    size_t first = quads.size();
+    Lowering lw{state, quads};
+    generate3ACHelper(TreeNodeRef(node), lw);
+    LOG_DEBUG("DEBUG: generate3AC - Finished generating %zu quads.\n", quads.size() - first);
+}
+
+void generate3AC(const PackedASTView& ast, TACState& state, std::vector<Quad>& quads) {
+    LOG_DEBUG("DEBUG: generate3AC - Top level function called (packed AST).\n");
+    size_t first = quads.size();
+    Lowering lw{state, quads};
+    generate3ACHelper(packedRoot(ast), lw);
+    LOG_DEBUG("DEBUG: generate3AC - Finished generating %zu quads.\n", quads.size() - first);
+}
+
+// --- Per-kind lowering, dispatched from generate3ACHelper ---
+// Each takes a node handle (TreeNodeRef or PackedNodeRef, see packed_ast.h), so the
+// pointer tree and the packed layout share one lowering.
+
+static void emitLabel(std::vector<Quad>& quads, Operand label) {
+    quads.push_back({QuadOp::Label, noOperand(), noOperand(), label});
+}
+
+static void emitGoto(std::vector<Quad>& quads, Operand label) {
+    quads.push_back({QuadOp::Goto, noOperand(), noOperand(), label});
+}
+
+// The parser builds stmt_list left-recursively, so its depth equals the statement count.
+// Flatten the spine first so only nesting of blocks and expressions uses native stack.
+template <typename Node>
+static Operand lowerStmtList(Node node, Lowering& lw) {
+    std::vector<Node> statements;
+    collectStatementsOf(node, statements);
+    for (Node stmt : statements) generate3ACHelper(stmt, lw);
+    return noOperand();
+}
+
+template <typename Node>
+static Operand lowerAssign(Node node, Lowering& lw) {
+    Operand rhs = generate3ACHelper(node.left(), lw);
+    lw.quads.push_back({QuadOp::Assign, rhs, noOperand(), varOperand(node.sym())});
+    return noOperand();
+}
+
+template <typename Node>
+static Operand lowerOp(Node node, Lowering& lw) {
+    switch (node.op()) {
+        case OpKind::PreInc:
+        case OpKind::PostInc:
+        case OpKind::PreDec:
+        case OpKind::PostDec: {
+            Operand var = generate3ACHelper(node.left(), lw);
+            Operand temp = lw.newTemp();
+            bool increment = node.op() == OpKind::PreInc || node.op() == OpKind::PostInc;
+            lw.quads.push_back({increment ? QuadOp::Add : QuadOp::Sub, var, immOperand(1), temp});
+            lw.quads.push_back({QuadOp::Assign, temp, noOperand(), var});
+            return var;
         }
+        default: {
+            Operand left_operand = generate3ACHelper(node.left(), lw);
+            Operand right_operand = generate3ACHelper(node.right(), lw);
+            Operand temp_var = lw.newTemp();
+            lw.quads.push_back({kBinaryQuadOp[static_cast<int>(node.op())], left_operand, right_operand, temp_var});
+            return temp_var;
+        }
+    }
+}
 
-        std::string default_label = default_stmt ? newLabel() : end_label;
-        quads.push_back({"goto", "", "", default_label});
+template <typename Node>
+static Operand lowerIf(Node node, Lowering& lw) {
+    Operand cond_result = generate3ACHelper(node.left(), lw);
+    Operand else_label = lw.newLabel();
+    lw.quads.push_back({QuadOp::IfFalse, cond_result, noOperand(), else_label});
+    if (node.right()) generate3ACHelper(node.right(), lw);
+    if (node.third()) {
+        Operand end_label = lw.newLabel();
+        emitGoto(lw.quads, end_label);
+        emitLabel(lw.quads, else_label);
+        generate3ACHelper(node.third(), lw);
+        emitLabel(lw.quads, end_label);
+    } else {
+        emitLabel(lw.quads, else_label);
+    }
+    return noOperand();
+}
 
-        // Generate code for case blocks
-        for (const auto& [label, stmt] : cases) {
-            quads.push_back({"label", "", "", label});
-            generate3ACHelper(stmt, quads);
+template <typename Node>
+static Operand lowerWhile(Node node, Lowering& lw) {
+    Operand start_label = lw.newLabel();
+    Operand end_label = lw.newLabel();
+    Operand old_break = lw.state.breakLabel;
+    lw.state.breakLabel = end_label;
+    emitLabel(lw.quads, start_label);
+    if (node.left()) {
+        Operand cond_res = generate3ACHelper(node.left(), lw);
+        lw.quads.push_back({QuadOp::IfFalse, cond_res, noOperand(), end_label});
+    }
+    if (node.right()) generate3ACHelper(node.right(), lw);
+    emitGoto(lw.quads, start_label);
+    emitLabel(lw.quads, end_label);
+    lw.state.breakLabel = old_break;
+    return noOperand();
+}
+
+template <typename Node>
+static Operand lowerFor(Node node, Lowering& lw) {
+    if (node.left()) generate3ACHelper(node.left(), lw);
+    Operand start_label = lw.newLabel();
+    Operand end_label = lw.newLabel();
+    Operand old_break = lw.state.breakLabel;
+    lw.state.breakLabel = end_label;
+    emitLabel(lw.quads, start_label);
+    if (node.right()) {
+        Operand cond_res = generate3ACHelper(node.right(), lw);
+        lw.quads.push_back({QuadOp::IfFalse, cond_res, noOperand(), end_label});
+    }
+    if (node.fourth()) generate3ACHelper(node.fourth(), lw);
+    if (node.third()) generate3ACHelper(node.third(), lw);
+    emitGoto(lw.quads, start_label);
+    emitLabel(lw.quads, end_label);
+    lw.state.breakLabel = old_break;
+    return noOperand();
+}
+
+template <typename Node>
+static Operand lowerBreak(Node, Lowering& lw) {
+    if (lw.state.breakLabel.kind == OperandKind::None) {
+        if (lw.state.diagnostics) {
+            lw.state.diagnostics->report("Semantic Error: 'break' statement not within a loop or switch.\n");
+        } else {
+            fprintf(stderr, "Semantic Error: 'break' statement not within a loop or switch.\n");
+            fflush(stderr);
         }
+    } else {
+        emitGoto(lw.quads, lw.state.breakLabel);
+    }
+    return noOperand();
+}
+
+template <typename Node>
+static Operand lowerSwitch(Node node, Lowering& lw) {
+    Operand expr = generate3ACHelper(node.left(), lw);
+    Operand end_label = lw.newLabel();
+    Operand old_break = lw.state.breakLabel;
+    lw.state.breakLabel = end_label;
 
-        // Generate code for default block
-        if (default_stmt) {
-            quads.push_back({"label", "", "", default_label});
-            generate3ACHelper(default_stmt, quads);
+    // case_list is built left-recursively, so the last entry is on top; collect the
+    // entries first so the comparisons run in source order.
+    std::vector<Node> entries;
+    for (Node case_list = node.right(); case_list; case_list = case_list.left()) {
+        if (case_list.right()) entries.push_back(case_list.right());
+    }
+
+    std::vector<std::pair<Operand, Node>> cases;
+    Node default_stmt;
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+        Node case_node = *it;
+        if (case_node.kind() == NodeKind::Case) {
+            Operand label = lw.newLabel();
+            Operand cond = lw.newTemp();
+            lw.quads.push_back({QuadOp::Eq, expr, immOperand(case_node.num()), cond});
+            lw.quads.push_back({QuadOp::If, cond, noOperand(), label});
+            cases.push_back({label, case_node.left()});
+        } else if (case_node.kind() == NodeKind::DefaultCase) {
+            default_stmt = case_node.left();
         }
+    }
+
+    Operand default_label = default_stmt ? lw.newLabel() : end_label;
+    emitGoto(lw.quads, default_label);
 
-        quads.push_back({"label", "", "", end_label});
-        currentBreakLabel = old_break;
-        return "";
+    // Generate code for case blocks
+    for (const auto& [label, stmt] : cases) {
+        emitLabel(lw.quads, label);
+        generate3ACHelper(stmt, lw);
     }
 
-    fprintf(stderr, "DEBUG WARNING: generate3ACHelper - Unhandled AST node type: [%s] with value [%s]\n",
-            node->type.c_str(), node->value.c_str());
-    fflush(stderr);
-    return "<UNHANDLED_AST_NODE_" + node->type + ">";
+    // Generate code for default block
+    if (default_stmt) {
+        emitLabel(lw.quads, default_label);
+        generate3ACHelper(default_stmt, lw);
+    }
+
+    emitLabel(lw.quads, end_label);
+    lw.state.breakLabel = old_break;
+    return noOperand();
 }
 
+template <typename Node>
+static Operand generate3ACHelper(Node node, Lowering& lw) {
+    if (!node) return noOperand();
+
+    switch (node.kind()) {
+        case NodeKind::StmtList: return lowerStmtList(node, lw);
+        case NodeKind::Assign:   return lowerAssign(node, lw);
+        case NodeKind::Id:       return varOperand(node.sym());
+        case NodeKind::Num:      return immOperand(node.num());
+        case NodeKind::Op:       return lowerOp(node, lw);
+        case NodeKind::If:       return lowerIf(node, lw);
+        case NodeKind::While:    return lowerWhile(node, lw);
+        case NodeKind::For:      return lowerFor(node, lw);
+        case NodeKind::Break:    return lowerBreak(node, lw);
+        case NodeKind::Switch:   return lowerSwitch(node, lw);
+        case NodeKind::CaseListEntry:
+        case NodeKind::Case:
+        case NodeKind::DefaultCase:
+            break; // Only meaningful inside a switch; handled by lowerSwitch.
+    }
+
+    fprintf(stderr, "DEBUG WARNING: generate3ACHelper - Unhandled AST node type: [%s]\n",
+            nodeKindName(node.kind()));
+    fflush(stderr);
+    return noOperand();
+}
@@ -2,18 +2,89 @@
 #define THREE_ADDRESS_CODE_H
 
 #include "ast.h"    // For ASTNode
+#include "symbol_table.h" // For Symbol, SymbolTable
+#include "diagnostics.h" // For Diagnostics
+#include <cstdint>  // For std::int32_t, std::uint8_t
+#include <ostream>  // For std::ostream
 #include <string>   // For std::string
+#include <string_view> // For std::string_view
 #include <vector>   // For std::vector
 
-// Definition of a single Three-Address Code instruction (Quadruple)
+// Operation of a quad. quadOpText() gives the spelling used when printing.
+enum class QuadOp : std::uint8_t {
+    Assign,     // result = arg1
+    Add, Sub, Mul, Div, Mod,
+    Lt, Gt, Le, Ge, Eq, Ne,
+    Label,      // result:
+    Goto,       // goto result
+    IfFalse,    // ifFalse arg1 goto result
+    If          // if arg1 goto result
+};
+
+enum class OperandKind : std::uint8_t {
+    None,
+    Temp,   // value is the temp number (t<value>)
+    Var,    // value is the variable's Symbol
+    Imm,    // value is the literal itself
+    Label   // value is the label number (L<value>)
+};
+
+struct Operand {
+    OperandKind kind;
+    std::int32_t value;
+};
+
+inline Operand noOperand() { return {OperandKind::None, 0}; }
+inline Operand tempOperand(int n) { return {OperandKind::Temp, n}; }
+inline Operand varOperand(Symbol s) { return {OperandKind::Var, static_cast<std::int32_t>(s)}; }
+inline Operand immOperand(int v) { return {OperandKind::Imm, v}; }
+inline Operand labelOperand(int n) { return {OperandKind::Label, n}; }
+
+// Definition of a single Three-Address Code instruction (Quadruple).
+// Plain data: copying or storing a quad never allocates.
 struct Quad {
-    std::string op;     // Operation (e.g., "+", "=", "ifFalse", "goto", "label")
-    std::string arg1;   // First argument or source
-    std::string arg2;   // Second argument or source (optional)
-    std::string result; // Result or destination/target label
+    QuadOp op;
+    Operand arg1;   // First argument or source
+    Operand arg2;   // Second argument or source (optional)
+    Operand result; // Result or destination/target label
+};
+
+bool isRelationalOp(QuadOp op);
+const char* quadOpText(QuadOp op);
+// Appends the printable form of an operand ("t3", "x", "42", "L1"; nothing for None).
+void appendOperandText(std::string& out, const Operand& operand, const SymbolTable& symbols);
+std::string operandText(const Operand& operand, const SymbolTable& symbols);
+// One quad as print3AC lists it ("t1 = a + b", "L2:", "ifFalse t1 goto L2").
+std::string quadText(const Quad& q, const SymbolTable& symbols);
+
+// Writes the listing shown by the driver ("--- Three-Address Code ---" ... one quad per line).
+void print3AC(const std::vector<Quad>& quads, const SymbolTable& symbols, std::ostream& out);
+
+// Reads such a listing back, appending its quads to `quads` and interning variables into
+// `symbols`. Lines print3AC writes around the quads ("---..." and "DEBUG: ...") are
+// skipped, as are blank lines and '#' comments, so driver output can be fed back as is.
+// The text form cannot tell a variable named like a temp from the temp: "t3" always
+// reads as temp 3. Temp and label numbers may not exceed the quad count by more than
+// k3ACNumberSlack (generate8086 keeps tables indexed by them). On a malformed line
+// returns false and sets `error` to "line N: ...".
+constexpr int k3ACNumberSlack = 1 << 16;
+bool parse3AC(std::string_view text, SymbolTable& symbols, std::vector<Quad>& quads, std::string& error);
+
+// Numbering state of the lowering pass. Temps and labels are numbered per compilation,
+// so each compilation keeps its own TACState instead of sharing counters.
+struct TACState {
+    int tempCount = 0;
+    int labelCount = 0;
+    Operand breakLabel = noOperand();   // Target of `break` in the innermost loop or switch
+    Diagnostics* diagnostics = nullptr; // Semantic errors go here; to stderr when null
 };
 
 // Function to generate a list of three-address code instructions from the AST
 std::vector<Quad> generate3AC(ASTNode* node);
+// Appends the quads for `node` to `quads`, continuing the numbering in `state`.
+void generate3AC(ASTNode* node, TACState& state, std::vector<Quad>& quads);
+// Same for a tree in the packed layout (see packed_ast.h); emits the same quads.
+struct PackedASTView;
+void generate3AC(const PackedASTView& ast, TACState& state, std::vector<Quad>& quads);
 
 #endif // THREE_ADDRESS_CODE_H
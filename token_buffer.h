@@ -0,0 +1,52 @@
+#ifndef TOKEN_BUFFER_H
+#define TOKEN_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Every token of one source, lexed before parsing starts (see lexTokens in scanner.h).
+// Stored column-wise: token i is kind[i], offset[i], length[i], line[i]. The text itself
+// stays in the source, so NUMBER values and identifiers are only produced as the parser
+// consumes the tokens. Offsets are 32-bit, which limits a buffer to sources under 4 GiB.
+struct TokenBuffer {
+    std::vector<std::uint16_t> kind;    // Token number from parser.tab.h, or kUnknownCharToken
+    std::vector<std::uint32_t> offset;  // Byte offset of the text in the source
+    std::vector<std::uint32_t> length;  // Byte length of the text
+    std::vector<std::uint32_t> line;    // Line the token is on
+    int endLine = 1;                    // Line the scanner ended on (after trailing newlines)
+
+    std::size_t size() const { return kind.size(); }
+
+    void push(int token, std::uint32_t tokenOffset, std::uint32_t tokenLength, std::uint32_t tokenLine) {
+        kind.push_back(static_cast<std::uint16_t>(token));
+        offset.push_back(tokenOffset);
+        length.push_back(tokenLength);
+        line.push_back(tokenLine);
+    }
+
+    void reserve(std::size_t tokens) {
+        kind.reserve(tokens);
+        offset.reserve(tokens);
+        length.reserve(tokens);
+        line.reserve(tokens);
+    }
+
+    void resize(std::size_t tokens) {
+        kind.resize(tokens);
+        offset.resize(tokens);
+        length.resize(tokens);
+        line.resize(tokens);
+    }
+
+    // Empties the buffer but keeps its capacity for the next source.
+    void clear() {
+        kind.clear();
+        offset.clear();
+        length.clear();
+        line.clear();
+        endLine = 1;
+    }
+};
+
+#endif // TOKEN_BUFFER_H
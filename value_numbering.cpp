@@ -0,0 +1,308 @@
+#include "value_numbering.h"
+#include "cfg.h"
+#include "verbosity.h"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+namespace {
+
+constexpr std::uint32_t kNoName = UINT32_MAX;
+constexpr std::uint32_t kUnknown = 0;  // Value number of a name nothing is known about
+
+// Expression keys pack the op and two value numbers into 64 bits, so value numbers must
+// fit in 30 bits. A quad creates at most three, which bounds the quads numbered.
+constexpr std::size_t kMaxQuads = (std::size_t(1) << 30) / 3;
+
+// Past this many blocks between a block and its immediate dominator, global mode stops
+// looking for the names set there and forgets every name the program sets instead.
+constexpr std::size_t kMaxKillBlocks = 4096;
+
+bool isArithmetic(QuadOp op) {
+    return op == QuadOp::Add || op == QuadOp::Sub || op == QuadOp::Mul || op == QuadOp::Div || op == QuadOp::Mod;
+}
+
+class ValueNumbering {
+public:
+    ValueNumbering(std::vector<Quad>& quads, const ControlFlowGraph& cfg, ValueNumberingStats& stats);
+
+    // Numbers every block on its own.
+    void runLocal();
+    // Numbers the reachable blocks down the dominator tree, then the others on their own.
+    void runGlobal();
+    // Drops the quads marked as removed.
+    void compact();
+
+private:
+    struct Change {
+        enum Kind : std::uint8_t { NameValue, Holder, Expression } kind;
+        std::uint32_t index;     // Name, or value number whose holder changed
+        std::uint32_t oldValue;  // NameValue
+        Operand oldHolder;       // Holder
+        std::uint64_t key;       // Expression inserted
+    };
+
+    std::uint32_t nameOf(const Operand& operand) const {
+        if (operand.kind == OperandKind::Var) return static_cast<std::uint32_t>(operand.value);
+        if (operand.kind == OperandKind::Temp) return static_cast<std::uint32_t>(varCount + operand.value);
+        return kNoName;
+    }
+    std::uint32_t freshValue(const Operand& holder) {
+        holders.push_back(holder);
+        return static_cast<std::uint32_t>(holders.size() - 1);
+    }
+    // A value's holder is a literal, or a name that still holds it.
+    bool hasHolder(std::uint32_t value) const {
+        const Operand& holder = holders[value];
+        if (holder.kind == OperandKind::Imm) return true;
+        if (holder.kind == OperandKind::None) return false;
+        return names[nameOf(holder)] == value;
+    }
+    void setName(std::uint32_t name, std::uint32_t value) {
+        log.push_back({Change::NameValue, name, names[name], noOperand(), 0});
+        names[name] = value;
+    }
+    std::uint32_t valueOf(const Operand& operand);
+    void define(const Operand& result, std::uint32_t value);
+    void numberBlock(std::uint32_t block);
+    void killBetween(std::uint32_t dominator, std::uint32_t block);
+    void undo(std::size_t mark);
+
+    std::vector<Quad>& quads;
+    const ControlFlowGraph& cfg;
+    ValueNumberingStats& stats;
+
+    // Variables are named by symbol and temps follow them.
+    std::size_t varCount = 0;
+    std::vector<std::uint32_t> names;  // Name -> value number it holds (kUnknown if none yet)
+    std::vector<Operand> holders;      // Value number -> a name or literal holding it
+    std::unordered_map<std::int32_t, std::uint32_t> literals;     // Never forgotten
+    std::unordered_map<std::uint64_t, std::uint32_t> expressions; // (op, value, value) -> value
+    std::vector<Change> log;           // Undone when a block's dominator subtree is done
+    std::vector<bool> removed;
+
+    // Global mode: the names each block sets, and the walk that finds the blocks between
+    // a block and its dominator.
+    std::vector<std::uint32_t> definitionBegin;  // Per block, into definitions
+    std::vector<std::uint32_t> definitions;
+    std::vector<std::uint32_t> visitedBy;        // Block -> last walk (block + 1) to visit it
+    std::vector<std::uint32_t> walk;
+};
+
+ValueNumbering::ValueNumbering(std::vector<Quad>& quads, const ControlFlowGraph& cfg, ValueNumberingStats& stats)
+    : quads(quads), cfg(cfg), stats(stats), removed(quads.size(), false) {
+    int maxVar = -1;
+    int maxTemp = -1;
+    for (const Quad& q : quads) {
+        for (const Operand* operand : {&q.arg1, &q.arg2, &q.result}) {
+            if (operand->kind == OperandKind::Var) maxVar = std::max(maxVar, operand->value);
+            else if (operand->kind == OperandKind::Temp) maxTemp = std::max(maxTemp, operand->value);
+        }
+    }
+    varCount = static_cast<std::size_t>(maxVar + 1);
+    names.assign(varCount + static_cast<std::size_t>(maxTemp + 1), kUnknown);
+    holders.push_back(noOperand());  // kUnknown
+    holders.reserve(quads.size() * 2);
+    expressions.reserve(quads.size() / 2);
+}
+
+std::uint32_t ValueNumbering::valueOf(const Operand& operand) {
+    if (operand.kind == OperandKind::Imm) {
+        auto [it, inserted] = literals.try_emplace(operand.value, 0);
+        if (inserted) it->second = freshValue(operand);
+        return it->second;
+    }
+    std::uint32_t name = nameOf(operand);
+    if (names[name] == kUnknown) setName(name, freshValue(operand));
+    return names[name];
+}
+
+void ValueNumbering::define(const Operand& result, std::uint32_t value) {
+    setName(nameOf(result), value);
+    if (!hasHolder(value)) {
+        log.push_back({Change::Holder, value, 0, holders[value], 0});
+        holders[value] = result;
+    }
+}
+
+void ValueNumbering::numberBlock(std::uint32_t block) {
+    for (std::uint32_t i = cfg.blocks[block].first; i < cfg.blocks[block].last; ++i) {
+        Quad& q = quads[i];
+        if (q.op == QuadOp::Assign) {
+            std::uint32_t value = valueOf(q.arg1);
+            if (names[nameOf(q.result)] == value) {
+                removed[i] = true;
+                ++stats.removed;
+                continue;
+            }
+            define(q.result, value);
+        } else if (isArithmetic(q.op)) {
+            std::uint64_t a = valueOf(q.arg1);
+            std::uint64_t b = valueOf(q.arg2);
+            if ((q.op == QuadOp::Add || q.op == QuadOp::Mul) && a > b) std::swap(a, b);
+            std::uint64_t key = (static_cast<std::uint64_t>(q.op) << 60) | (a << 30) | b;
+            auto it = expressions.find(key);
+            if (it == expressions.end()) {
+                std::uint32_t value = freshValue(q.result);
+                expressions.emplace(key, value);
+                log.push_back({Change::Expression, 0, 0, noOperand(), key});
+                setName(nameOf(q.result), value);
+                continue;
+            }
+            std::uint32_t value = it->second;
+            if (names[nameOf(q.result)] == value) {
+                removed[i] = true;
+                ++stats.removed;
+                continue;
+            }
+            if (hasHolder(value)) {
+                q = {QuadOp::Assign, holders[value], noOperand(), q.result};
+                ++stats.reused;
+            }
+            define(q.result, value);
+        } else if (q.op != QuadOp::Label && q.op != QuadOp::Goto && q.op != QuadOp::If && q.op != QuadOp::IfFalse) {
+            define(q.result, freshValue(q.result));  // A comparison
+        }
+    }
+}
+
+// Forgets the names set on the way from the end of `dominator` to the start of `block`:
+// those of every block that reaches `block` without passing through `dominator`.
+void ValueNumbering::killBetween(std::uint32_t dominator, std::uint32_t block) {
+    walk.clear();
+    for (std::uint32_t p : cfg.predecessors(block)) {
+        if (p != dominator && visitedBy[p] != block + 1) {
+            visitedBy[p] = block + 1;
+            walk.push_back(p);
+        }
+    }
+    for (std::size_t i = 0; i < walk.size() && walk.size() <= kMaxKillBlocks; ++i) {
+        for (std::uint32_t p : cfg.predecessors(walk[i])) {
+            if (p != dominator && visitedBy[p] != block + 1) {
+                visitedBy[p] = block + 1;
+                walk.push_back(p);
+            }
+        }
+    }
+    auto forget = [&](std::uint32_t name) {
+        if (names[name] != kUnknown) setName(name, kUnknown);
+    };
+    if (walk.size() > kMaxKillBlocks) {
+        for (std::uint32_t name : definitions) forget(name);
+        return;
+    }
+    for (std::uint32_t b : walk) {
+        for (std::uint32_t d = definitionBegin[b]; d < definitionBegin[b + 1]; ++d) forget(definitions[d]);
+    }
+}
+
+void ValueNumbering::undo(std::size_t mark) {
+    while (log.size() > mark) {
+        const Change& change = log.back();
+        switch (change.kind) {
+            case Change::NameValue: names[change.index] = change.oldValue; break;
+            case Change::Holder: holders[change.index] = change.oldHolder; break;
+            case Change::Expression: expressions.erase(change.key); break;
+        }
+        log.pop_back();
+    }
+}
+
+void ValueNumbering::runLocal() {
+    for (std::uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+        undo(0);
+        numberBlock(b);
+    }
+    undo(0);
+}
+
+void ValueNumbering::runGlobal() {
+    std::vector<std::uint32_t> idom = immediateDominators(cfg);
+
+    // Dominator tree children, block by block, in reverse postorder.
+    std::vector<std::uint32_t> childBegin(cfg.blocks.size() + 1, 0);
+    for (std::uint32_t b : cfg.reversePostorder) {
+        if (idom[b] != kNoBlock) ++childBegin[idom[b] + 1];
+    }
+    for (std::size_t b = 0; b < cfg.blocks.size(); ++b) childBegin[b + 1] += childBegin[b];
+    std::vector<std::uint32_t> children(childBegin.back());
+    std::vector<std::uint32_t> childEnd(childBegin.begin(), childBegin.end() - 1);
+    for (std::uint32_t b : cfg.reversePostorder) {
+        if (idom[b] != kNoBlock) children[childEnd[idom[b]]++] = b;
+    }
+
+    definitionBegin.assign(cfg.blocks.size() + 1, 0);
+    for (std::uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+        for (std::uint32_t i = cfg.blocks[b].first; i < cfg.blocks[b].last; ++i) {
+            std::uint32_t name = nameOf(quads[i].result);
+            if (name != kNoName) definitions.push_back(name);
+        }
+        definitionBegin[b + 1] = static_cast<std::uint32_t>(definitions.size());
+    }
+    visitedBy.assign(cfg.blocks.size(), 0);
+
+    // Preorder walk; each block undoes its changes once its subtree is done.
+    struct Visit {
+        std::uint32_t block;
+        std::uint32_t nextChild;
+        std::size_t mark;
+    };
+    std::vector<bool> numbered(cfg.blocks.size(), false);
+    std::vector<Visit> stack;
+    if (!cfg.reversePostorder.empty()) {
+        std::uint32_t entry = cfg.reversePostorder[0];
+        stack.push_back({entry, childBegin[entry], log.size()});
+        numberBlock(entry);
+        numbered[entry] = true;
+    }
+    while (!stack.empty()) {
+        Visit& visit = stack.back();
+        if (visit.nextChild == childEnd[visit.block]) {
+            undo(visit.mark);
+            stack.pop_back();
+            continue;
+        }
+        std::uint32_t child = children[visit.nextChild++];
+        stack.push_back({child, childBegin[child], log.size()});
+        killBetween(idom[child], child);
+        numberBlock(child);
+        numbered[child] = true;
+    }
+    for (std::uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+        if (numbered[b]) continue;
+        undo(0);
+        numberBlock(b);
+    }
+    undo(0);
+}
+
+void ValueNumbering::compact() {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < quads.size(); ++i) {
+        if (!removed[i]) quads[kept++] = quads[i];
+    }
+    quads.resize(kept);
+}
+
+} // end anonymous namespace
+
+bool numberValues(std::vector<Quad>& quads, bool global, ValueNumberingStats& stats, std::string& error) {
+    stats = ValueNumberingStats();
+    stats.quadsBefore = stats.quadsAfter = quads.size();
+    ControlFlowGraph cfg;
+    if (!buildCFG(quads, cfg, error)) return false;
+    if (quads.size() > kMaxQuads) {
+        LOG_DEBUG("DEBUG: numberValues - %zu quads is too many to number, skipped.\n", quads.size());
+        return true;
+    }
+
+    ValueNumbering numbering(quads, cfg, stats);
+    if (global) numbering.runGlobal();
+    else numbering.runLocal();
+    numbering.compact();
+
+    stats.quadsAfter = quads.size();
+    LOG_DEBUG("DEBUG: numberValues - %zu -> %zu quads (%s, %zu reused, %zu removed).\n",
+              stats.quadsBefore, stats.quadsAfter, global ? "global" : "local", stats.reused, stats.removed);
+    return true;
+}
@@ -0,0 +1,37 @@
+#ifndef VALUE_NUMBERING_H
+#define VALUE_NUMBERING_H
+
+#include "three_address_code.h" // For Quad
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// --- Value numbering ---
+// Gives every value the quads compute a number. Names that hold the same value share
+// its number, and `a op b` gets the number already given to the same op on the same
+// operand numbers (a + b and b + a alike). When a quad computes a value some name still
+// holds, the arithmetic is not done again:
+//   t2 = a * b   becomes   t2 = t1   if t1 = a * b came first and t1, a and b were
+//                                    not set in between
+//   x = t1       is dropped          if x already holds the value of t1
+// Setting a name gives it a new number, which is what makes entries on its old value
+// unusable. Comparisons are not numbered: generate8086 turns the quad that sets a
+// condition temp into the CMP of the ifFalse reading it, so that quad has to stay.
+//
+// Local mode numbers each basic block on its own. Global mode walks the dominator tree
+// (cfg.h): a block starts from what its immediate dominator knew at its end, minus the
+// names set in the blocks between them (any block on a path from the dominator to it,
+// loops included).
+
+struct ValueNumberingStats {
+    std::size_t quadsBefore = 0;
+    std::size_t quadsAfter = 0;
+    std::size_t reused = 0;   // Computations replaced by a copy of an earlier result
+    std::size_t removed = 0;  // Quads setting a name to the value it already held
+};
+
+// Rewrites `quads` in place, across blocks if `global`. Fails only if they do not form a
+// control-flow graph (see buildCFG), setting `error` and leaving them untouched.
+bool numberValues(std::vector<Quad>& quads, bool global, ValueNumberingStats& stats, std::string& error);
+
+#endif // VALUE_NUMBERING_H
@@ -0,0 +1,15 @@
+#include "verbosity.h"
+#include <cstring>
+
+int verbosityLevel = MINICOMPILER_MAX_VERBOSITY;
+
+bool parseVerbosity(const char* text, int& level) {
+    static const char* const names[] = {"quiet", "normal", "debug", "trace"};
+    for (int i = VERBOSITY_QUIET; i <= VERBOSITY_TRACE; ++i) {
+        if ((text[0] == '0' + i && text[1] == '\0') || strcmp(text, names[i]) == 0) {
+            level = i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,39 @@
+#ifndef VERBOSITY_H
+#define VERBOSITY_H
+
+#include <cstdio> // For printf
+
+// How much the compiler reports on stdout. Each level includes the ones below it.
+//   QUIET  - nothing; only the requested artifacts (e.g. output.asm) and errors on stderr
+//   NORMAL - the AST, the 3AC listing and the generated assembly
+//   DEBUG  - progress messages from each stage ("DEBUG: ...")
+//   TRACE  - one line per token from the lexer
+#define VERBOSITY_QUIET  0
+#define VERBOSITY_NORMAL 1
+#define VERBOSITY_DEBUG  2
+#define VERBOSITY_TRACE  3
+
+// Upper bound fixed at build time. Anything above it compiles to nothing, so a
+// release build (-DMINICOMPILER_MAX_VERBOSITY=VERBOSITY_QUIET) pays no cost for logging.
+#ifndef MINICOMPILER_MAX_VERBOSITY
+#define MINICOMPILER_MAX_VERBOSITY VERBOSITY_TRACE
+#endif
+
+// Level selected at run time; defaults to everything the build allows.
+extern int verbosityLevel;
+
+// Reads a level given as 0..3 or by name (quiet, normal, debug, trace) into `level`.
+// Returns false, leaving `level` alone, for anything else.
+bool parseVerbosity(const char* text, int& level);
+
+#define VERBOSITY_ENABLED(level) \
+    ((level) <= MINICOMPILER_MAX_VERBOSITY && (level) <= verbosityLevel)
+
+#define LOG_AT(level, ...) \
+    do { if (VERBOSITY_ENABLED(level)) printf(__VA_ARGS__); } while (0)
+
+#define LOG_NORMAL(...) LOG_AT(VERBOSITY_NORMAL, __VA_ARGS__)
+#define LOG_DEBUG(...)  LOG_AT(VERBOSITY_DEBUG, __VA_ARGS__)
+#define LOG_TRACE(...)  LOG_AT(VERBOSITY_TRACE, __VA_ARGS__)
+
+#endif // VERBOSITY_H
@@ -1,188 +1,340 @@
 #include "x8086_generator.h"
-#include <iostream> // For std::cerr (though printf/fprintf is used more here)
-#include <fstream>  // For std::ofstream
+#include "verbosity.h"
 #include <string>
 #include <vector>
-#include <set>
-#include <map>
-#include <cctype> // For std::isdigit
-#include <cstdio> // For printf, fprintf, fflush
-
-// Anonymous namespace for helper local to this file
-namespace {
-    bool isNumber_8086(const std::string& s) {
-        if (s.empty()) return false;
-        for (char const &c : s) {
-            if (std::isdigit(c) == 0) return false;
-        }
-        return true;
-    }
+#include <algorithm> // For std::sort
+#include <climits> // For INT_MAX
+#include <cstdio> // For fprintf, fflush, tmpfile
 
-    // Helper function to write to both file and terminal
-    void writeAsm(std::ofstream& outfile, const std::string& line) {
-        outfile << line << "\n";
-        printf("%s\n", line.c_str()); // Print to terminal
-    }
-    // Overload for char* (though std::string is preferred for safety)
-    void writeAsm(std::ofstream& outfile, const char* line_cstr) {
-        if (line_cstr) {
-            outfile << line_cstr << "\n";
-            printf("%s\n", line_cstr); 
-        } else {
-            fprintf(stderr, "DEBUG WARNING: writeAsm received null char*\n");
-            fflush(stderr);
-        }
+// Quads to translate: a plain array, so quads held in a vector and quads mapped from a
+// file go through the same code.
+struct QuadRange {
+    const Quad* first;
+    const Quad* last;
+    const Quad* begin() const { return first; }
+    const Quad* end() const { return last; }
+    std::size_t size() const { return last - first; }
+};
+
+// Which quad defined each of the temps first .. first + count - 1.
+struct TempDefinitions {
+    int first;
+    const Quad* const* quads;
+    std::size_t count;
+
+    const Quad* find(const Operand& temp) const {
+        if (temp.kind != OperandKind::Temp || temp.value < first || (size_t)(temp.value - first) >= count)
+            return nullptr;
+        return quads[temp.value - first];
     }
+};
+
+static void translate(QuadRange quads, AsmEmitter& out);
+// The pieces of a program around its .DATA entries, and the translation of the quads.
+static void emitHeader(AsmEmitter& out);
+static void emitCodeStart(AsmEmitter& out);
+static void emitCode(QuadRange quads, TempDefinitions temp_definitions, AsmEmitter& out);
+static void emitExit(AsmEmitter& out);
 
-} // end anonymous namespace
+void generate8086(const std::vector<Quad>& quads, const SymbolTable& symbols, const std::string& filename) {
+    generate8086(quads.data(), quads.size(), symbols, filename);
+}
+
+void generate8086(const std::vector<Quad>& quads, AsmEmitter& out) {
+    translate({quads.data(), quads.data() + quads.size()}, out);
+}
 
-void generate8086(const std::vector<Quad>& quads, const std::string& filename) {
-    printf("DEBUG: *** Entered generate8086 function. ***\n");
-    fflush(stdout); 
+void generate8086(const Quad* quads, std::size_t count, AsmEmitter& out) {
+    translate({quads, quads + count}, out);
+}
 
-    printf("DEBUG: generate8086 - Output filename: %s\n", filename.c_str());
-    fflush(stdout);
-    printf("DEBUG: generate8086 - Number of quads received: %zu\n", quads.size());
-    fflush(stdout);
+void generate8086(const Quad* quads, std::size_t count, const SymbolTable& symbols, const std::string& filename) {
+    LOG_DEBUG("DEBUG: *** Entered generate8086 function. ***\n");
+    LOG_DEBUG("DEBUG: generate8086 - Output filename: %s\n", filename.c_str());
+    LOG_DEBUG("DEBUG: generate8086 - Number of quads received: %zu\n", count);
 
-    std::ofstream outfile(filename);
-    if (!outfile.is_open()) {
+    AsmEmitter out(symbols, filename);
+    if (!out.ok()) {
         fprintf(stderr, "DEBUG CRITICAL ERROR: In generate8086 - Could not open output file '%s'. Terminating function.\n", filename.c_str());
         fflush(stderr);
         return; 
     }
-    printf("DEBUG: generate8086 - Successfully opened output file '%s'.\n", filename.c_str());
-    fflush(stdout);
+    LOG_DEBUG("DEBUG: generate8086 - Successfully opened output file '%s'.\n", filename.c_str());
 
-    printf("--- Generated 8086 Assembly (also written to %s) ---\n", filename.c_str()); 
-    fflush(stdout);
+    LOG_NORMAL("--- Generated 8086 Assembly (also written to %s) ---\n", filename.c_str());
+    if (VERBOSITY_ENABLED(VERBOSITY_NORMAL)) {
+        fflush(stdout);
+        out.setEcho(stdout); // Show the same text on the terminal
+    }
 
-    std::set<std::string> variables;
-    std::map<std::string, Quad> temp_definitions;
+    generate8086(quads, count, out);
 
-    // Pass 1: Collect all variable names
-    for (const auto& q : quads) {
-        if (!q.arg1.empty() && !isNumber_8086(q.arg1)) variables.insert(q.arg1);
-        if (!q.arg2.empty() && !isNumber_8086(q.arg2)) variables.insert(q.arg2);
-        if (!q.result.empty() && q.op != "label" && q.op != "goto") {
-            variables.insert(q.result);
-            // Ensure result is not empty before checking its first character
-            if (!q.result.empty() && q.result[0] == 't') { 
-                temp_definitions[q.result] = q;
+    if (!out.finish()) {
+        fprintf(stderr, "DEBUG CRITICAL ERROR: In generate8086 - Writing '%s' failed.\n", filename.c_str());
+        fflush(stderr);
+    }
+    LOG_NORMAL("------------------------------------------------------\n");
+    LOG_DEBUG("DEBUG: generate8086 - Closed output file. Function finished.\n");
+}
+
+static void translate(QuadRange quads, AsmEmitter& out) {
+    // Pass 1: Collect every variable and temp that needs a data word, and remember
+    // which quad defined each temp (indexed by temp number).
+    const SymbolTable& symbols = out.symbolTable();
+    std::vector<bool> seen_vars(symbols.size(), false);
+    std::vector<bool> seen_temps;
+    std::vector<const Quad*> temp_definitions;
+    std::vector<std::string> variables;
+    auto collect = [&](const Operand& operand) {
+        if (operand.kind == OperandKind::Var) {
+            if (seen_vars[operand.value]) return;
+            seen_vars[operand.value] = true;
+        } else if (operand.kind == OperandKind::Temp) {
+            if ((size_t)operand.value >= seen_temps.size()) {
+                seen_temps.resize(operand.value + 1, false);
+                temp_definitions.resize(operand.value + 1, nullptr);
             }
+            if (seen_temps[operand.value]) return;
+            seen_temps[operand.value] = true;
+        } else {
+            return;
         }
+        variables.push_back(operandText(operand, symbols));
+    };
+    for (const auto& q : quads) {
+        collect(q.arg1);
+        collect(q.arg2);
+        collect(q.result);
+        if (q.result.kind == OperandKind::Temp) temp_definitions[q.result.value] = &q;
     }
+    std::sort(variables.begin(), variables.end());
 
-    writeAsm(outfile, ".MODEL SMALL");
-    writeAsm(outfile, ".STACK 100h");
-    writeAsm(outfile, ".DATA");
+    emitHeader(out);
     for (const auto& var : variables) {
-        std::string line = "    " + var + " DW ?";
-        writeAsm(outfile, line);
+        out.line("    ", var, " DW ?");
     }
+    emitCodeStart(out);
+    emitCode(quads, {0, temp_definitions.data(), temp_definitions.size()}, out);
+    emitExit(out);
+}
 
-    writeAsm(outfile, "\n.CODE");
-    writeAsm(outfile, "MAIN PROC");
-    writeAsm(outfile, "    MOV AX, @DATA");
-    writeAsm(outfile, "    MOV DS, AX");
-    // Add a newline to terminal for readability after boilerplate
-    if (variables.size() > 0) printf("\n"); // Only if data segment was not empty
-    else printf("\n\n"); // If data segment was empty, ensure .CODE starts clearly
+static void emitHeader(AsmEmitter& out) {
+    out.line(".MODEL SMALL");
+    out.line(".STACK 100h");
+    out.line(".DATA");
+}
 
+static void emitCodeStart(AsmEmitter& out) {
+    out.line("\n.CODE");
+    out.line("MAIN PROC");
+    out.line("    MOV AX, @DATA");
+    out.line("    MOV DS, AX");
+}
 
+static void emitCode(QuadRange quads, TempDefinitions temp_definitions, AsmEmitter& out) {
+    const SymbolTable& symbols = out.symbolTable();
     // Pass 2: Translate Quads to Simplified 8086
     for (const auto& q : quads) {
-        std::string asm_line1, asm_line2, asm_line3, asm_line4; 
+        switch (q.op) {
+            case QuadOp::Label:
+                out.line(q.result, ":");
+                break;
 
-        if (q.op == "label") {
-            asm_line1 = q.result + ":";
-            writeAsm(outfile, asm_line1);
-        }
-        else if (q.op == "=") {
-            if (isNumber_8086(q.arg1)) {
-                asm_line1 = "    MOV " + q.result + ", " + q.arg1;
-                writeAsm(outfile, asm_line1);
-            } 
-            else {
-                asm_line1 = "    MOV AX, " + q.arg1;
-                asm_line2 = "    MOV " + q.result + ", AX";
-                writeAsm(outfile, asm_line1);
-                writeAsm(outfile, asm_line2);
-            }
-        }
-        else if (q.op == "+" || q.op == "-") {
-            asm_line1 = "    MOV AX, " + q.arg1;
-            asm_line2 = "    MOV BX, " + q.arg2;
-            writeAsm(outfile, asm_line1);
-            writeAsm(outfile, asm_line2);
-            if (q.op == "+") asm_line3 = "    ADD AX, BX";
-            else if (q.op == "-") asm_line3 = "    SUB AX, BX"; // Added else if for clarity
-            else { /* Should not happen if op is only + or - here */ }
-            writeAsm(outfile, asm_line3);
-            asm_line4 = "    MOV " + q.result + ", AX";
-            writeAsm(outfile, asm_line4);
-        }
-        else if (q.op == "goto") {
-            asm_line1 = "    JMP " + q.result;
-            writeAsm(outfile, asm_line1);
-        }
-        else if (q.op == "ifFalse") {
-            if (!q.arg1.empty() && temp_definitions.count(q.arg1)) {
-                Quad condition = temp_definitions.at(q.arg1); 
-                if (condition.arg1.empty() || condition.arg2.empty() || condition.op.empty()) {
-                    fprintf(stderr, "DEBUG WARNING: x8086_generator - Corrupt condition for ifFalse (temp: %s, cond.arg1: %s, cond.op: %s, cond.arg2: %s)\n", 
-                            q.arg1.c_str(), condition.arg1.c_str(), condition.op.c_str(), condition.arg2.c_str());
-                    fflush(stderr);
-                    continue; 
-                }
-                asm_line1 = "    MOV AX, " + condition.arg1;
-                asm_line2 = "    CMP AX, " + condition.arg2;
-                writeAsm(outfile, asm_line1);
-                writeAsm(outfile, asm_line2);
-
-                std::string jump_instruction;
-                if(condition.op == "==") jump_instruction = "JNE"; 
-                else if(condition.op == "!=") jump_instruction = "JE";  
-                else if(condition.op == "<")  jump_instruction = "JGE"; 
-                else if(condition.op == "<=") jump_instruction = "JG";  
-                else if(condition.op == ">")  jump_instruction = "JLE"; 
-                else if(condition.op == ">=") jump_instruction = "JL";  
+            case QuadOp::Assign:
+                if (q.arg1.kind == OperandKind::Imm) {
+                    out.line("    MOV ", q.result, ", ", q.arg1);
+                } 
                 else {
-                    fprintf(stderr, "DEBUG WARNING: x8086_generator - Unhandled condition.op '%s' for ifFalse (temp '%s').\n", 
-                            condition.op.c_str(), q.arg1.c_str());
-                    fflush(stderr);
+                    out.line("    MOV AX, ", q.arg1);
+                    out.line("    MOV ", q.result, ", AX");
                 }
-                if (!jump_instruction.empty()) {
-                    asm_line3 = "    " + jump_instruction + " " + q.result;
-                    writeAsm(outfile, asm_line3);
+                break;
+
+            case QuadOp::Add:
+            case QuadOp::Sub:
+                out.line("    MOV AX, ", q.arg1);
+                out.line("    MOV BX, ", q.arg2);
+                out.line(q.op == QuadOp::Add ? "    ADD AX, BX" : "    SUB AX, BX");
+                out.line("    MOV ", q.result, ", AX");
+                break;
+
+            case QuadOp::Mul:
+                // IMUL leaves the product in DX:AX; the low word is the 16-bit result.
+                out.line("    MOV AX, ", q.arg1);
+                out.line("    MOV BX, ", q.arg2);
+                out.line("    IMUL BX");
+                out.line("    MOV ", q.result, ", AX");
+                break;
+
+            case QuadOp::Div:
+            case QuadOp::Mod:
+                // IDIV divides DX:AX (AX sign-extended by CWD), truncating toward zero:
+                // the quotient goes to AX and the remainder, signed like the dividend, to DX.
+                out.line("    MOV AX, ", q.arg1);
+                out.line("    CWD");
+                out.line("    MOV BX, ", q.arg2);
+                out.line("    IDIV BX");
+                out.line("    MOV ", q.result, q.op == QuadOp::Div ? ", AX" : ", DX");
+                break;
+
+            case QuadOp::Goto:
+                out.line("    JMP ", q.result);
+                break;
+
+            case QuadOp::IfFalse:
+            case QuadOp::If: {
+                const char* op = quadOpText(q.op);
+                const Quad* condition = temp_definitions.find(q.arg1);
+                if (!condition) {
+                    out.warn("DEBUG WARNING: x8086_generator - Temp variable '%s' for %s not in temp_definitions or empty.\n",
+                             operandText(q.arg1, symbols).c_str(), op);
+                    break;
+                }
+                if (condition->arg1.kind == OperandKind::None || condition->arg2.kind == OperandKind::None) {
+                    out.warn("DEBUG WARNING: x8086_generator - Corrupt condition for %s (temp: %s, cond.arg1: %s, cond.op: %s, cond.arg2: %s)\n",
+                             op, operandText(q.arg1, symbols).c_str(), operandText(condition->arg1, symbols).c_str(),
+                             quadOpText(condition->op), operandText(condition->arg2, symbols).c_str());
+                    break;
+                }
+                out.line("    MOV AX, ", condition->arg1);
+                out.line("    CMP AX, ", condition->arg2);
+
+                // ifFalse jumps when the comparison fails, if when it holds.
+                bool jumpIfTrue = q.op == QuadOp::If;
+                const char* jump_instruction = nullptr;
+                switch (condition->op) {
+                    case QuadOp::Eq: jump_instruction = jumpIfTrue ? "JE"  : "JNE"; break;
+                    case QuadOp::Ne: jump_instruction = jumpIfTrue ? "JNE" : "JE";  break;
+                    case QuadOp::Lt: jump_instruction = jumpIfTrue ? "JL"  : "JGE"; break;
+                    case QuadOp::Le: jump_instruction = jumpIfTrue ? "JLE" : "JG";  break;
+                    case QuadOp::Gt: jump_instruction = jumpIfTrue ? "JG"  : "JLE"; break;
+                    case QuadOp::Ge: jump_instruction = jumpIfTrue ? "JGE" : "JL";  break;
+                    default:
+                        out.warn("DEBUG WARNING: x8086_generator - Unhandled condition.op '%s' for %s (temp '%s').\n",
+                                 quadOpText(condition->op), op, operandText(q.arg1, symbols).c_str());
+                        break;
+                }
+                if (jump_instruction) {
+                    out.line("    ", jump_instruction, " ", q.result);
                 }
-            } else {
-                fprintf(stderr, "DEBUG WARNING: x8086_generator - Temp variable '%s' for ifFalse not in temp_definitions or empty.\n", 
-                        q.arg1.c_str());
-                fflush(stderr);
+                break;
             }
+
+            case QuadOp::Lt:
+            case QuadOp::Gt:
+            case QuadOp::Le:
+            case QuadOp::Ge:
+            case QuadOp::Eq:
+            case QuadOp::Ne:
+                // Relational operations that create a temporary are translated by the
+                // ifFalse / if that tests it.
+                break;
         }
-        else if (!q.result.empty() && q.result[0] == 't' && 
-                 (q.op == "==" || q.op == "!=" || q.op == "<" || q.op == "<=" || q.op == ">" || q.op == ">=")) {
-            // This is a relational operation that creates a temporary.
-            // Silently ignore it, as its logic is handled by the "ifFalse" case.
-        }
-        // Add a small empty line to terminal for readability between 3AC instruction translations
-        if (!q.op.empty() && q.op != "label") printf("\n"); 
-        fflush(stdout); // Flush after each instruction's translation
     }
+}
+
+static void emitExit(AsmEmitter& out) {
+    out.line("\n    ; Exit the program");
+    out.line("    MOV AH, 4Ch");
+    out.line("    INT 21h");
+    out.line("MAIN ENDP");
+    out.line("END MAIN");
+}
+
+// --- Streaming8086 ---
 
-    printf("\n"); // Final newline before exit boilerplate
-    fflush(stdout);
-    writeAsm(outfile, "\n    ; Exit the program");
-    writeAsm(outfile, "    MOV AH, 4Ch");
-    writeAsm(outfile, "    INT 21h");
-    writeAsm(outfile, "MAIN ENDP");
-    writeAsm(outfile, "END MAIN");
-
-    outfile.close();
-    printf("------------------------------------------------------\n"); 
-    printf("DEBUG: generate8086 - Closed output file. Function finished.\n"); 
-    fflush(stdout);
+Streaming8086::Streaming8086(const SymbolTable& symbols)
+    : symbols(symbols), scratch(tmpfile()), code(std::make_unique<AsmEmitter>(symbols, scratch)) {}
+
+Streaming8086::~Streaming8086() {
+    code.reset();
+    if (scratch) fclose(scratch);
+}
+
+bool Streaming8086::ok() const {
+    return code->ok();
 }
 
+void Streaming8086::use(const Operand& operand) {
+    std::vector<bool>* seen = nullptr;
+    if (operand.kind == OperandKind::Var) seen = &seenVars;
+    else if (operand.kind == OperandKind::Temp) seen = &seenTemps;
+    else return;
+    if ((size_t)operand.value >= seen->size()) seen->resize(std::max<size_t>(operand.value + 1, 2 * seen->size()), false);
+    (*seen)[operand.value] = true;
+}
+
+void Streaming8086::add(const Quad* quads, std::size_t count) {
+    // The temps of one statement are numbered consecutively, so a small table indexed
+    // from the lowest of them covers every ifFalse condition.
+    int first = INT_MAX;
+    int last = -1;
+    for (std::size_t i = 0; i < count; ++i) {
+        const Quad& q = quads[i];
+        use(q.arg1);
+        use(q.arg2);
+        use(q.result);
+        if (q.result.kind == OperandKind::Temp) {
+            first = std::min(first, q.result.value);
+            last = std::max(last, q.result.value);
+        }
+    }
+    definitions.clear();
+    if (last >= first) {
+        definitions.resize(static_cast<size_t>(last - first) + 1, nullptr);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (quads[i].result.kind == OperandKind::Temp) definitions[quads[i].result.value - first] = &quads[i];
+        }
+    }
+    emitCode({quads, quads + count}, {first, definitions.data(), definitions.size()}, *code);
+}
+
+bool Streaming8086::finish(AsmEmitter& out) {
+    // .DATA lists the names in sorted order, as translate() does. The variable names are
+    // few and get sorted as strings; the temps, which can number in the millions, are
+    // visited directly in the order their names sort ("t1", "t10", "t100", "t11", ...)
+    // and merged in.
+    std::vector<std::string> variables;
+    for (size_t i = 0; i < seenVars.size(); ++i) {
+        if (seenVars[i]) variables.emplace_back(symbols.name(static_cast<Symbol>(i)));
+    }
+    std::sort(variables.begin(), variables.end());
+
+    emitHeader(out);
+    size_t nextVariable = 0;
+    auto variablesBefore = [&](const std::string* bound) {
+        while (nextVariable < variables.size() && (!bound || variables[nextVariable] < *bound))
+            out.line("    ", variables[nextVariable++], " DW ?");
+    };
+    std::string temp;
+    auto emitTemp = [&](long number) {
+        temp = "t" + std::to_string(number);
+        variablesBefore(&temp);
+        out.line("    ", temp, " DW ?");
+    };
+    if (!seenTemps.empty() && seenTemps[0]) emitTemp(0);  // Only a 3AC listing can name t0
+    long limit = static_cast<long>(seenTemps.size()) - 1;  // Highest temp number that may be used
+    long current = 1;
+    for (long visited = 0; visited < limit; ++visited) {
+        if (seenTemps[current]) emitTemp(current);
+        if (current * 10 <= limit) {
+            current *= 10;
+        } else {
+            if (current >= limit) current /= 10;
+            ++current;
+            while (current % 10 == 0) current /= 10;
+        }
+    }
+    variablesBefore(nullptr);
+    emitCodeStart(out);
+
+    bool written = code->finish() && fseek(scratch, 0, SEEK_SET) == 0;
+    if (written) {
+        std::vector<char> chunk(1 << 16);
+        while (size_t n = fread(chunk.data(), 1, chunk.size(), scratch))
+            out.appendChunk(std::string_view(chunk.data(), n));
+        written = !ferror(scratch);
+    }
+    emitExit(out);
+    return written;
+}
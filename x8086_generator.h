@@ -2,11 +2,54 @@
 #define X8086_GENERATOR_H
 
 #include "three_address_code.h" // For Quad
+#include "asm_emitter.h"        // For AsmEmitter
+#include <cstdio>
+#include <memory>
 #include <string>
 #include <vector>
 
-// ✅ THIS MUST EXIST:
-void generate8086(const std::vector<Quad>& quads, const std::string& filename);
+// Writes the program to `filename` (and echoes it to stdout at NORMAL verbosity).
+void generate8086(const std::vector<Quad>& quads, const SymbolTable& symbols, const std::string& filename);
+// Emits the program into any sink: a file, a stream or an in-memory buffer. Variable names
+// come from the emitter's symbol table.
+void generate8086(const std::vector<Quad>& quads, AsmEmitter& out);
+// Same over `count` quads stored anywhere (e.g. mapped from an IR file, see ir_file.h).
+void generate8086(const Quad* quads, std::size_t count, const SymbolTable& symbols, const std::string& filename);
+void generate8086(const Quad* quads, std::size_t count, AsmEmitter& out);
+
+// Code generation for a program whose quads arrive a few at a time (see
+// compileStreaming). add() translates its quads at once into a scratch file and keeps
+// only which variables and temps they use, one bit each; finish() writes the .DATA
+// entries for those and then copies the code after them. The result is what
+// generate8086 writes for all the quads together, as long as each ifFalse comes in the
+// same add() as the quad defining its condition (true for every statement the
+// lowering pass produces).
+class Streaming8086 {
+public:
+    explicit Streaming8086(const SymbolTable& symbols);
+    ~Streaming8086();
+
+    Streaming8086(const Streaming8086&) = delete;
+    Streaming8086& operator=(const Streaming8086&) = delete;
+
+    // False if the scratch file could not be created or written.
+    bool ok() const;
+
+    void add(const Quad* quads, std::size_t count);
+
+    // Writes the whole program to `out`. Returns false if the scratch file failed.
+    bool finish(AsmEmitter& out);
+
+private:
+    void use(const Operand& operand);
+
+    const SymbolTable& symbols;
+    FILE* scratch;
+    std::unique_ptr<AsmEmitter> code;
+    std::vector<bool> seenVars;
+    std::vector<bool> seenTemps;
+    std::vector<const Quad*> definitions;  // Reused by add()
+};
 
 #endif // X8086_GENERATOR_H
 